@@ -0,0 +1,153 @@
+/*
+ *
+ * Micro-benchmark of the ray-circle tests of projectiles
+ *
+ * Times Bullet::CheckCollision() one circle at a time against the batched
+ * kernels of ray_circle.h, for batches of growing size, after checking
+ * that they all give the same answers
+ *
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include <glm/gtc/constants.hpp>
+#include "bullet.h"
+#include "ray_circle.h"
+
+// Batch sizes, and the minimum time each benchmark runs for
+const int batch_sizes_g[] = { 8, 64, 512, 4096 };
+const int num_batch_sizes_g = sizeof(batch_sizes_g) / sizeof(batch_sizes_g[0]);
+const double min_bench_time_g = 0.2;
+
+const double time_step_g = 1.0 / 60.0;
+
+// Keeps the results alive, so the compiler can't drop the work
+static volatile unsigned int sink_g;
+
+
+// Random rays and circles near them, as bullets and enemies would be
+struct Scene {
+    std::vector<game::Bullet*> bullets;
+    std::vector<float> cx, cy, r;
+
+    Scene(int count, std::mt19937 &random);
+    ~Scene();
+};
+
+
+Scene::Scene(int count, std::mt19937 &random)
+{
+    std::uniform_real_distribution<float> coordinate(-10.0f, 10.0f);
+    std::uniform_real_distribution<float> angle(0.0f, 2.0f * glm::pi<float>());
+    std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> radius(0.2f, 0.7f);
+    std::uniform_int_distribution<int> steps(1, 30);
+
+    for (int i = 0; i < count; i++) {
+        game::Bullet *bullet = new game::Bullet(glm::vec3(0.0f), nullptr, nullptr, game::TextureRegion(), 1.0f, 1.0f, 1);
+        float a = angle(random);
+        bullet->SetOrigin(glm::vec3(coordinate(random), coordinate(random), 0.0f));
+        bullet->SetVelocity(18.0f * glm::vec3(cos(a), sin(a), 0.0f));
+        int n = steps(random);
+        for (int step = 0; step < n; step++) bullet->Update(time_step_g);
+        bullets.push_back(bullet);
+
+        // A circle around the end of the bullet's last update, so some of
+        // them are hit
+        glm::vec3 end = bullet->GetPosition();
+        cx.push_back(end.x + offset(random));
+        cy.push_back(end.y + offset(random));
+        r.push_back(radius(random));
+    }
+}
+
+
+Scene::~Scene()
+{
+    for (int i = 0; i < bullets.size(); i++) delete bullets[i];
+}
+
+
+// Run body until min_bench_time_g has passed, and print the time per
+// call and per test in the style of Google Benchmark
+template <typename Body>
+static void Bench(const std::string &name, int size, Body body)
+{
+    long iterations = 0;
+    std::chrono::duration<double> time(0.0);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    while (time.count() < min_bench_time_g) {
+        body();
+        iterations++;
+        time = std::chrono::steady_clock::now() - start;
+    }
+    double ns = time.count() * 1e9 / iterations;
+    std::printf("%-28s %10.0f ns %10.2f ns/test %12ld\n", (name + "/" + std::to_string(size)).c_str(), ns, ns / size, iterations);
+}
+
+
+int main(void){
+    std::mt19937 random(2501);
+    std::printf("%-28s %13s %18s %12s\n", "Benchmark", "Time", "Per test", "Iterations");
+
+    int mismatches = 0;
+    for (int s = 0; s < num_batch_sizes_g; s++) {
+        int size = batch_sizes_g[s];
+        Scene scene(size, random);
+        game::Bullet *bullet = scene.bullets[0];
+        glm::vec3 circle(scene.cx[0], scene.cy[0], 0.0f);
+
+        // One bullet against every circle, and every bullet against one circle
+        game::CircleBatch circles;
+        game::RayBatch rays;
+        for (int i = 0; i < size; i++) {
+            circles.Add(glm::vec2(scene.cx[i], scene.cy[i]), scene.r[i]);
+            scene.bullets[i]->AddSweep(rays);
+        }
+        bullet->CheckCollisions(circles);
+        rays.Sweep(glm::vec2(circle.x, circle.y), scene.r[0]);
+        for (int i = 0; i < size; i++) {
+            if (circles.GetHit(i) != bullet->CheckCollision(glm::vec3(scene.cx[i], scene.cy[i], 0.0f), scene.r[i])) mismatches++;
+            if (rays.GetHit(i) != scene.bullets[i]->CheckCollision(circle, scene.r[0])) mismatches++;
+        }
+
+        Bench("BM_CheckCollision", size, [&]() {
+            unsigned int hits = 0;
+            for (int i = 0; i < size; i++) {
+                hits += bullet->CheckCollision(glm::vec3(scene.cx[i], scene.cy[i], 0.0f), scene.r[i]);
+            }
+            sink_g = hits;
+        });
+        Bench("BM_CircleBatch", size, [&]() {
+            bullet->CheckCollisions(circles);
+            sink_g = circles.GetHit(size - 1);
+        });
+        Bench("BM_RayBatch", size, [&]() {
+            rays.Sweep(glm::vec2(circle.x, circle.y), scene.r[0]);
+            sink_g = rays.GetHit(size - 1);
+        });
+
+        // The kernels alone, scalar and vectorized
+        std::vector<unsigned int> mask((size + 31) / 32);
+        glm::vec2 P(bullet->GetSweepStart().x, bullet->GetSweepStart().y);
+        glm::vec2 d(bullet->GetVelocity().x, bullet->GetVelocity().y);
+        Bench("BM_SweepCirclesScalar", size, [&]() {
+            game::SweepCirclesScalar(P, d, 0.0f, 1.0f, scene.cx.data(), scene.cy.data(), scene.r.data(), size, mask.data());
+            sink_g = mask[0];
+        });
+        Bench("BM_SweepCirclesVector", size, [&]() {
+            game::SweepCirclesVector(P, d, 0.0f, 1.0f, scene.cx.data(), scene.cy.data(), scene.r.data(), size, mask.data());
+            sink_g = mask[0];
+        });
+    }
+
+    if (mismatches > 0) {
+        std::cerr << mismatches << " batched tests differ from Bullet::CheckCollision()" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,249 @@
+/*
+ *
+ * Benchmark of the game simulation, without a window
+ *
+ * Fills a headless game with mines, sharks, subs, javelins and particle
+ * trails, runs a fixed number of steps, and reports the time, the heap
+ * allocations and the number of objects per step, for each scenario size
+ *
+ * Once warmed up, the steps must not allocate at all, and a boss parked
+ * ahead of the camera must not wake up
+ *
+ * Each scenario runs on one thread and then on several, and the two runs
+ * must end in the same state
+ *
+ */
+
+#include <iostream>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <atomic>
+#include <thread>
+#include "game.h"
+
+// Every heap allocation of the program goes through here, so the
+// benchmark can count those made by the simulation steps
+// All the forms are replaced, so none of them mixes with the library's
+// The simulation's worker threads allocate too, so the count is atomic
+static std::atomic<long> allocations_g(0);
+
+static void *Allocate(std::size_t size)
+{
+    allocations_g++;
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void *operator new(std::size_t size)
+{
+    void *block = Allocate(size);
+    if (block == nullptr) throw std::bad_alloc();
+    return block;
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    return Allocate(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return Allocate(size);
+}
+
+void operator delete(void *block) noexcept { std::free(block); }
+void operator delete[](void *block) noexcept { std::free(block); }
+void operator delete(void *block, std::size_t) noexcept { std::free(block); }
+void operator delete[](void *block, std::size_t) noexcept { std::free(block); }
+void operator delete(void *block, const std::nothrow_t &) noexcept { std::free(block); }
+void operator delete[](void *block, const std::nothrow_t &) noexcept { std::free(block); }
+
+// Scenario sizes: number of objects spawned before the steps
+const int bench_sizes_g[] = { 10, 100, 1000, 10000, 100000 };
+const int num_bench_sizes_g = sizeof(bench_sizes_g) / sizeof(bench_sizes_g[0]);
+
+// Kinds of object spawned, by their name in wave files, and their default
+// share of a scenario
+const char *bench_types_g[] = { "mine", "shark", "sub", "javelin", "trail" };
+const int num_bench_types_g = sizeof(bench_types_g) / sizeof(bench_types_g[0]);
+const int default_weights_g[num_bench_types_g] = { 3, 2, 2, 2, 1 };
+
+// Distance between objects, and how far ahead of the camera the first row is
+const float bench_spacing_g = 0.75f;
+const float bench_first_row_g = 2.0f;
+
+const double bench_time_step_g = 1.0 / 60.0;
+
+// Steps run before measuring, while the pools and buffers grow to the
+// sizes the scenario needs; after them a step must not allocate
+const int bench_warm_up_ticks_g = 60;
+
+// Steps a parked boss is watched for, longer than its turrets' cool down
+const int bench_parked_ticks_g = 300;
+
+
+// Spawn size objects in a grid ahead of the camera, each kind getting its
+// share of the grid in turn, so the kinds are mixed like in a real wave
+// The objects are written as a wave file, so they get the game's defaults
+static void Populate(game::Game &game, int size, const int weights[])
+{
+    int total_weight = 0;
+    for (int type = 0; type < num_bench_types_g; type++) total_weight += weights[type];
+
+    std::string text;
+    char line[64];
+    int columns = (int)std::ceil(std::sqrt((double)size));
+    int spawned[num_bench_types_g] = { 0 };
+    for (int i = 0; i < size; i++) {
+        // Pick the kind furthest behind its share so far
+        int type = 0;
+        double lag = -1.0;
+        for (int t = 0; t < num_bench_types_g; t++) {
+            if (weights[t] == 0) continue;
+            double t_lag = (double)weights[t] * (i + 1) / total_weight - spawned[t];
+            if (t_lag > lag) {
+                lag = t_lag;
+                type = t;
+            }
+        }
+        spawned[type]++;
+
+        float x = ((i % columns) - 0.5f * columns) * bench_spacing_g;
+        float y = bench_first_row_g + (i / columns) * bench_spacing_g;
+        std::snprintf(line, sizeof(line), "0 %s %g %g\n", bench_types_g[type], x, y);
+        text += line;
+    }
+
+    game::WaveTimeline scenario;
+    scenario.Parse(text, "scenario");
+    const game::WaveEvent *event;
+    while ((event = scenario.Next(0.0)) != nullptr) {
+        game.SpawnWaveEvent(*event);
+    }
+}
+
+
+// Park a boss far ahead of the camera and check that it sleeps for a few
+// seconds, its turrets with it, so they don't shoot from outside the view
+static void CheckParkedBoss(void)
+{
+    game::Game the_game;
+    the_game.SetWaveFile("");
+    the_game.InitHeadless();
+    the_game.Setup();
+    the_game.SetPlayerInvincible();
+
+    game::WaveTimeline scenario;
+    scenario.Parse("0 boss 0 40\n", "parked boss");
+    const game::WaveEvent *event;
+    while ((event = scenario.Next(0.0)) != nullptr) {
+        the_game.SpawnWaveEvent(*event);
+    }
+
+    for (int tick = 0; tick < bench_parked_ticks_g; tick++) {
+        the_game.Step(bench_time_step_g);
+        if (the_game.GetNumAwake(game::BossObj) != 0 || the_game.GetNumAwake(game::TurretObj) != 0) {
+            throw(std::runtime_error(std::string("A boss parked ahead of the camera woke up, or its turrets did")));
+        }
+    }
+}
+
+
+// Run a scenario on the given number of threads, print its times, and
+// get the checksum of the state it ends in
+static unsigned long long RunScenario(int size, int threads, int ticks, const int weights[])
+{
+    game::Game the_game;
+    the_game.SetWaveFile("");
+    the_game.SetNumThreads(threads);
+    // Room for the scenario's objects and what they spawn
+    the_game.SetCapacity(2 * size + 1024);
+    the_game.InitHeadless();
+    the_game.Setup();
+    // The scenario measures the steps, not how long the player lasts
+    the_game.SetPlayerInvincible();
+    Populate(the_game, size, weights);
+    for (int tick = 0; tick < bench_warm_up_ticks_g; tick++) {
+        the_game.Step(bench_time_step_g);
+    }
+
+    long objects = 0;
+    long start_allocations = allocations_g;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < ticks; tick++) {
+        the_game.Step(bench_time_step_g);
+        objects += the_game.GetNumObjects();
+    }
+    std::chrono::duration<double, std::nano> time = std::chrono::steady_clock::now() - start;
+    long allocations = allocations_g - start_allocations;
+
+    std::printf("%8d %8d %14.0f %14.2f %14.1f\n", size, threads, time.count() / ticks,
+        (double)allocations / ticks, (double)objects / ticks);
+    if (allocations != 0) {
+        throw(std::runtime_error(std::string("The steps after warming up allocated ") + std::to_string(allocations) + " times"));
+    }
+    return the_game.GetChecksum();
+}
+
+
+// Run with [--threads N] [ticks] [mine shark sub javelin trail], the
+// threads of the parallel runs (one per core by default), the number of
+// steps of each scenario and the share of each kind of object
+int main(int argc, char *argv[]){
+    int threads = (int)std::thread::hardware_concurrency();
+    int first_arg = 1;
+    if (argc > 2 && std::string(argv[1]) == "--threads") {
+        threads = std::atoi(argv[2]);
+        first_arg = 3;
+    }
+    int ticks = 300;
+    int weights[num_bench_types_g];
+    for (int type = 0; type < num_bench_types_g; type++) weights[type] = default_weights_g[type];
+    if (argc > first_arg) ticks = std::atoi(argv[first_arg]);
+    for (int type = 0; type < num_bench_types_g && argc > first_arg + type + 1; type++) {
+        weights[type] = std::atoi(argv[first_arg + type + 1]);
+    }
+
+    int total_weight = 0;
+    for (int type = 0; type < num_bench_types_g; type++) total_weight += weights[type];
+    if (ticks <= 0 || total_weight <= 0 || threads <= 0) {
+        std::cerr << "Usage: bench_sim [--threads N] [ticks] [mine shark sub javelin trail]" << std::endl;
+        return 1;
+    }
+
+    std::cout << ticks << " ticks of " << bench_time_step_g << " s, objects spawned as";
+    for (int type = 0; type < num_bench_types_g; type++) {
+        std::cout << " " << weights[type] << " " << bench_types_g[type];
+    }
+    std::cout << std::endl;
+    std::printf("%8s %8s %14s %14s %14s\n", "size", "threads", "ns/tick", "allocs/tick", "objects/tick");
+
+    try {
+        CheckParkedBoss();
+        for (int s = 0; s < num_bench_sizes_g; s++) {
+            unsigned long long serial = RunScenario(bench_sizes_g[s], 1, ticks, weights);
+            if (threads == 1) continue;
+            unsigned long long parallel = RunScenario(bench_sizes_g[s], threads, ticks, weights);
+            if (parallel != serial) {
+                std::cerr << "The run on " << threads << " threads ended in another state than the run on one" << std::endl;
+                return 1;
+            }
+        }
+    }
+    catch (std::exception &e){
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
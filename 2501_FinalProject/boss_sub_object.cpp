@@ -4,7 +4,7 @@
 
 namespace game {
 
-BossSubObject::BossSubObject(const glm::vec3 &position, Geometry *geom, Shader *shader, GLuint texture, float yScale, float xScale, int health)
+BossSubObject::BossSubObject(const glm::vec3 &position, Geometry *geom, Shader *shader, const TextureRegion &texture, float yScale, float xScale, int health)
 	: GameObject(position, geom, shader, texture, yScale, xScale, health) {
 
 	target_ = nullptr;
@@ -13,7 +13,6 @@ BossSubObject::BossSubObject(const glm::vec3 &position, Geometry *geom, Shader *
 	type_ = EnemyObj;
 	lastSecond_ = 0;
 	docile_ = true;
-	next_shot_ = 3.0;
 }
 
 // Generic mapping function
@@ -9,15 +9,13 @@ namespace game {
     class BossTurretObject : public GameObject {
 
         public:
-            BossTurretObject(const glm::vec3 &position, Geometry *geom, Shader *shader, GLuint texture, GameObject* parent, glm::vec3 fake_position, float yScale, float xScale, int health);
+            BossTurretObject(const glm::vec3 &position, Geometry *geom, Shader *shader, const TextureRegion &texture, const Handle &parent, glm::vec3 fake_position, float yScale, float xScale, int health);
 
             // Update function for moving the player object around
             void Update(double delta_time) override;
 
-            void Render(glm::mat4 view_matrix, double current_time);
-
-            inline void SetNextShot(double value) { next_shot_ = value; }
-            inline double GetNextShot(void) { return next_shot_; }
+            // Drawn at a fixed offset from the boss, without turning with it
+            void Snapshot(RenderSnapshot &snapshot) const override;
 
             inline glm::vec3 GetFakePosition(void) const { return fake_position_; }
 
@@ -26,11 +24,8 @@ namespace game {
             void SetTarget(GameObject *t) { target_ = t; }
         protected:
             GameObject *target_;
-            GameObject* parent_;
             double wander_cool_down_;
             double current_time_;
-            double next_shot_;
-
 
             glm::vec3 fake_position_;
 
@@ -1,24 +1,44 @@
 #include "bullet.h"
+#include "object_pool.h"
 #include <iostream>
 #include <glm/gtc/constants.hpp>
 
 namespace game {
 
-Bullet::Bullet(const glm::vec3 &position, Geometry *geom, Shader *shader, GLuint texture, float yScale, float xScale, int health)
+Bullet::Bullet(const glm::vec3 &position, Geometry *geom, Shader *shader, const TextureRegion &texture, float yScale, float xScale, int health)
 	: GameObject(position, geom, shader, texture, yScale, xScale, health) {
-	lifespan_ = new Timer();
 	current_time_ = 0.0;
 	last_time_ = 0.0;
 	type_ = BulletObj;
-	lifespan_->Start(5.0);
+	lifespan_ = 5.0;
 }
 
 Bullet::~Bullet() {
 	//std::cout << "DELTED" << std::endl;
-	if (particles_ != nullptr) {
-		std::cout << particles_->GetRotation() << std::endl;
-		particles_->SetAlive(false);
+}
+
+// Pool shared by all bullets and torpedoes
+static ObjectPool &BulletPool(void) {
+	static ObjectPool pool(sizeof(Bullet), 128);
+	return pool;
+}
+
+void *Bullet::operator new(std::size_t size) {
+	// Classes derived from Bullet have a different size and use the heap
+	if (size != sizeof(Bullet)) return ::operator new(size);
+	return BulletPool().Allocate();
+}
+
+void Bullet::operator delete(void *block, std::size_t size) {
+	if (size != sizeof(Bullet)) {
+		::operator delete(block);
+		return;
 	}
+	BulletPool().Free(block);
+}
+
+void Bullet::ReservePool(int count) {
+	BulletPool().Reserve(count);
 }
 
 // Check for possible intersections between a ray (P, d) and a circle (C, r)
@@ -83,6 +103,19 @@ bool Bullet::CheckCollision(glm::vec3 C, float r){
 }
 
 
+void Bullet::CheckCollisions(CircleBatch &circles) const {
+	float t_min, t_max;
+	SweepBounds(last_time_, current_time_, t_min, t_max);
+	circles.Sweep(glm::vec2(origin_.x, origin_.y), glm::vec2(velocity_.x, velocity_.y), t_min, t_max);
+}
+
+void Bullet::AddSweep(RayBatch &rays) const {
+	float t_min, t_max;
+	SweepBounds(last_time_, current_time_, t_min, t_max);
+	rays.Add(glm::vec2(origin_.x, origin_.y), glm::vec2(velocity_.x, velocity_.y), t_min, t_max);
+}
+
+
 // Update function for moving the player object around
 void Bullet::Update(double delta_time) {
 
@@ -94,10 +127,8 @@ void Bullet::Update(double delta_time) {
 	current_time_ += delta_time;
 
 	// Update position based on current time, origin, and bullet direction
-	position_ = origin_ + ((float)current_time_)*velocity_;
-	if (lifespan_->Finished()) alive_ = false;
-
-	// Add some code to limit the lifespan of the bullet...
+	// Bullets in the game's motion store are moved by it instead
+	if (motion_index_ < 0) position_ = origin_ + ((float)current_time_)*velocity_;
 }
 
 } // namespace game
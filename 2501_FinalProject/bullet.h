@@ -1,7 +1,10 @@
 #ifndef BULLET_H_
 #define BULLET_H_
 
+#include <cstddef>
+
 #include "game_object.h"
+#include "ray_circle.h"
 
 namespace game {
 
@@ -9,20 +12,37 @@ namespace game {
     class Bullet : public GameObject {
 
         public:
-            Bullet(const glm::vec3 &position, Geometry *geom, Shader *shader, GLuint texture, float yScale, float xScale, int health);
+            Bullet(const glm::vec3 &position, Geometry *geom, Shader *shader, const TextureRegion &texture, float yScale, float xScale, int health);
             ~Bullet();
+
+            // Bullets are allocated from a pool, so firing does not reach the heap
+            static void *operator new(std::size_t size);
+            static void operator delete(void *block, std::size_t size);
+
+            // Make room in the pool for count bullets and torpedoes
+            static void ReservePool(int count);
+
             // Update function for moving the player object around
             void Update(double delta_time) override;
 
             // Bullet variables
-            void SetOrigin(glm::vec3 origin) { origin_ = origin; }
+            // The bullet starts at its origin
+            void SetOrigin(glm::vec3 origin) { origin_ = origin; position_ = origin; }
 
             bool CheckCollision(glm::vec3 C, float r);
+
+            // Batched forms of CheckCollision(), with the same answers
+            // Test the last update against every circle of a batch
+            void CheckCollisions(CircleBatch &circles) const;
+            // Add the last update to rays tested together against one circle
+            void AddSweep(RayBatch &rays) const;
+
+            // Start of the segment the bullet covered in its last update
+            glm::vec3 GetSweepStart(void) const { return origin_ + ((float)last_time_) * velocity_; }
         protected:
             double current_time_;
             double last_time_;
             glm::vec3 origin_;
-            Timer* lifespan_;
     }; // class Bullet
 
 } // namespace game
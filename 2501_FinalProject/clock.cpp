@@ -0,0 +1,10 @@
+#include "clock.h"
+
+namespace game {
+
+SimulationClock::SimulationClock(void)
+{
+    time_ = 0.0;
+}
+
+} // namespace game
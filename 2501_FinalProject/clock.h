@@ -0,0 +1,39 @@
+#ifndef CLOCK_H_
+#define CLOCK_H_
+
+
+namespace game {
+
+    // Source of the current time in seconds, used by TimerWheel
+    class Clock {
+
+        public:
+            virtual ~Clock() {}
+
+            // Current time in seconds
+            virtual double GetTime(void) const = 0;
+
+    }; // class Clock
+
+
+    // Simulation clock that only moves when it is advanced by the game
+    // Time is not tied to the wall clock, so it stops and steps with the
+    // simulation
+    class SimulationClock : public Clock {
+
+        public:
+            SimulationClock(void);
+
+            double GetTime(void) const override { return time_; }
+
+            // Move the clock forward by delta_time seconds
+            void Advance(double delta_time) { time_ += delta_time; }
+
+        private:
+            double time_;
+
+    }; // class SimulationClock
+
+} // namespace game
+
+#endif // CLOCK_H_
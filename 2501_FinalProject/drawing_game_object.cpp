@@ -1,44 +1,19 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "drawing_game_object.h"
+#include "render_snapshot.h"
 
 namespace game {
 
-DrawingGameObject::DrawingGameObject(const glm::vec3 &position, Geometry *geom, Shader *shader, GLuint texture, float yScale, float xScale, int health) 
-    : GameObject(position, geom, shader, texture, yScale, xScale, health) { }
-
-
-void DrawingGameObject::Render(glm::mat4 view_matrix, double current_time) {
-
-    // Set up the shader
-    shader_->Enable();
-
-    // Set up the view matrix
-    shader_->SetUniformMat4("view_matrix", view_matrix);
-
-    // Setup the scaling matrix for the shader
-    glm::mat4 scaling_matrix = glm::scale(glm::mat4(1.0f), glm::vec3(scale_ * xScale_, scale_ * yScale_, 1.0f));
-
-    // Setup the rotation matrix for the shader
-    glm::mat4 rotation_matrix = glm::rotate(glm::mat4(1.0f), angle_, glm::vec3(0.0, 0.0, 1.0));
-
-    // Set up the translation matrix for the shader
-    glm::mat4 translation_matrix = glm::translate(glm::mat4(1.0f), position_);
-
-    // Setup the transformation matrix for the shader
-    glm::mat4 transformation_matrix = translation_matrix * rotation_matrix * scaling_matrix;
-
-    // Set the transformation matrix in the shader
-    shader_->SetUniformMat4("transformation_matrix", transformation_matrix);
+DrawingGameObject::DrawingGameObject(const glm::vec3 &position, Geometry *geom, Shader *shader, const TextureRegion &texture, float yScale, float xScale, int health) 
+    : GameObject(position, geom, shader, texture, yScale, xScale, health) {
+}
 
-    // Set up the geometry
-    geometry_->SetGeometry(shader_->GetShaderProgram());
 
-    // Bind the entity's texture
-    glBindTexture(GL_TEXTURE_2D, texture_);
+void DrawingGameObject::Snapshot(RenderSnapshot &snapshot) const {
 
-    // Draw the entity
-    glDrawElements(GL_TRIANGLES, geometry_->GetSize(), GL_UNSIGNED_INT, 0);
+    GameObject::Snapshot(snapshot);
+    snapshot.records.back().kind = ShapeDraw;
 }
 
 } // namespace game
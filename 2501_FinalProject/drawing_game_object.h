@@ -9,10 +9,10 @@ namespace game {
     class DrawingGameObject : public GameObject {
 
         public:
-            DrawingGameObject(const glm::vec3 &position, Geometry *geom, Shader *shader, GLuint texture, float yScale, float xScale, int health);
+            DrawingGameObject(const glm::vec3 &position, Geometry *geom, Shader *shader, const TextureRegion &texture, float yScale, float xScale, int health);
 
-            // Render function for the text
-            void Render(glm::mat4 view_matrix, double current_time) override;
+            // Drawn with its own shader
+            void Snapshot(RenderSnapshot &snapshot) const override;
 
     }; // class DrawingGameObject
 
@@ -9,7 +9,7 @@ namespace game {
     class EnemyGameObject : public GameObject {
 
         public:
-            EnemyGameObject(const glm::vec3 &position, Geometry *geom, Shader *shader, GLuint texture, float yScale, float xScale, int health);
+            EnemyGameObject(const glm::vec3 &position, Geometry *geom, Shader *shader, const TextureRegion &texture, float yScale, float xScale, int health);
 
             // Update function for moving the player object around
             void Update(double delta_time) override;
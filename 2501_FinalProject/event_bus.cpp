@@ -0,0 +1,54 @@
+#include "event_bus.h"
+
+namespace game {
+
+void EventBus::Clear(void)
+{
+    order_.clear();
+    damage_.clear();
+    kills_.clear();
+    scores_.clear();
+    spawns_.clear();
+}
+
+
+void EventBus::Reserve(int count)
+{
+    order_.reserve(count);
+    damage_.reserve(count);
+    kills_.reserve(count);
+    scores_.reserve(count);
+    spawns_.reserve(count);
+}
+
+
+void EventBus::Publish(const DamageEvent &event)
+{
+    EventRef ref = { DamageEventType, (int)damage_.size() };
+    order_.push_back(ref);
+    damage_.push_back(event);
+}
+
+
+void EventBus::Publish(const KillEvent &event)
+{
+    EventRef ref = { KillEventType, (int)kills_.size() };
+    order_.push_back(ref);
+    kills_.push_back(event);
+}
+
+
+void EventBus::Publish(const ScoreEvent &event)
+{
+    EventRef ref = { ScoreEventType, (int)scores_.size() };
+    order_.push_back(ref);
+    scores_.push_back(event);
+}
+
+
+void EventBus::Request(const SpawnRequest &request)
+{
+    spawns_.push_back(request);
+}
+
+} // namespace game
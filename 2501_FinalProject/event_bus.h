@@ -0,0 +1,102 @@
+#ifndef EVENT_BUS_H_
+#define EVENT_BUS_H_
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "slot_map.h"
+
+namespace game {
+
+    // Gameplay events, published while collisions are detected and applied
+    // after, so detecting collisions doesn't change the game
+
+    // target takes amount damage from source: a projectile, or an enemy
+    // the player ran into
+    struct DamageEvent {
+        Handle target;
+        Handle source;
+        int amount;
+    };
+
+    // target is destroyed by cause
+    struct KillEvent {
+        Handle target;
+        Handle cause;
+    };
+
+    // The player picked up an item worth points
+    struct ScoreEvent {
+        Handle item;
+        int points;
+    };
+
+    enum GameEventType { DamageEventType, KillEventType, ScoreEventType };
+
+    // Objects to add once the events are applied
+    enum SpawnKind {
+        // Particles attached to parent at offset position
+        SpawnExplosion,
+        // A power-up item at position
+        SpawnPowerUp,
+        // A line of text rising from the top of the view, gone after lifetime
+        SpawnBanner };
+
+    struct SpawnRequest {
+        SpawnKind kind;
+        Handle parent;
+        glm::vec3 position;
+        float scale;
+        const char *text;
+        double lifetime;
+    };
+
+    // Events of one step, kept in the order they were published
+    // Spawn requests are kept apart: they are carried out after all the
+    // events, so no object is added while the others are being looked at
+    class EventBus {
+
+        public:
+            EventBus(void) {}
+
+            // Remove the events of the last step, keeping the memory
+            void Clear(void);
+
+            // Make room for count events, of any types, and count spawn
+            // requests, so publishing them never reallocates
+            void Reserve(int count);
+
+            void Publish(const DamageEvent &event);
+            void Publish(const KillEvent &event);
+            void Publish(const ScoreEvent &event);
+            void Request(const SpawnRequest &request);
+
+            // Events in the order they were published
+            inline int GetNumEvents(void) const { return (int)order_.size(); }
+            inline GameEventType GetType(int i) const { return order_[i].type; }
+            // Get event i, which must be of the matching type
+            inline const DamageEvent &GetDamage(int i) const { return damage_[order_[i].index]; }
+            inline const KillEvent &GetKill(int i) const { return kills_[order_[i].index]; }
+            inline const ScoreEvent &GetScore(int i) const { return scores_[order_[i].index]; }
+
+            inline int GetNumSpawns(void) const { return (int)spawns_.size(); }
+            inline const SpawnRequest &GetSpawn(int i) const { return spawns_[i]; }
+
+        private:
+            // Type of an event, and where it is in the list of its type
+            struct EventRef {
+                GameEventType type;
+                int index;
+            };
+
+            std::vector<EventRef> order_;
+            std::vector<DamageEvent> damage_;
+            std::vector<KillEvent> kills_;
+            std::vector<ScoreEvent> scores_;
+            std::vector<SpawnRequest> spawns_;
+
+    }; // class EventBus
+
+} // namespace game
+
+#endif // EVENT_BUS_H_
@@ -1,29 +1,31 @@
 #include <stdexcept>
 #include <string>
+#include <algorithm>
 #define GLM_FORCE_RADIANS
 #include <glm/gtc/matrix_transform.hpp> 
 #include <SOIL/SOIL.h>
 #include <iostream>
+#include <chrono>
+#include <cstdio>
 
 #include <path_config.h>
 
 #include "sprite.h"
-#include "particles.h"
 #include "shader.h"
 #include "player_game_object.h"
 #include "particle_system.h"
 #include "game.h"
 #include "enemy_game_object.h"
 #include "bullet.h"
-#include "tile.h"
 #include "text_game_object.h"
 #include "mine_enemy_object.h"
 #include "shark_enemy_object.h"
 #include "sub_enemy_object.h"
 #include "boss_sub_object.h"
 #include "boss_turret_object.h"
-#include "explosion_particles.h"
 #include "item_game_object.h"
+#include "render_state.h"
+#include "profiler.h"
 
 namespace game {
 
@@ -36,13 +38,90 @@ const unsigned int window_width_g = 800;
 const unsigned int window_height_g = 600;
 const glm::vec3 viewport_background_color_g(0.0, 0.0, 1.0);
 
+// The simulation advances in fixed steps, independent of the frame rate
+const double sim_time_step_g = 1.0 / 60.0;
+// Most steps simulated in one frame when catching up after a slow frame
+const int max_sim_steps_g = 5;
+
+// Activation band, keyed on the camera's scroll: objects further ahead of
+// the camera sleep until it reaches them, and objects further behind are
+// left for good and retired
+const float activation_ahead_g = 8.0f;
+const float activation_behind_g = 6.0f;
+
+// The view, in world units around the camera; the simulation uses the
+// designed window's aspect ratio so it doesn't depend on the window
+const float camera_zoom_g = 0.25f;
+const glm::vec2 view_half_size_g(((float)window_width_g / window_height_g) / camera_zoom_g, 1.0f / camera_zoom_g);
+// Projectiles are retired once they leave the view by more than this
+const float projectile_margin_g = 1.0f;
+
+// Speed the camera scrolls up at
+const float scroll_speed_g = 1.0f;
+
+// Objects per chunk of the parallel update systems, and projectiles per
+// chunk of the sweeps; smaller loops run on the main thread alone
+const int update_grain_g = 256;
+const int sweep_grain_g = 16;
+
+// Objects the object stores make room for, unless told otherwise
+const int max_objects_g = 1024;
+
 // Directory with game resources such as textures
 const std::string resources_directory_g = RESOURCES_DIRECTORY;
 
+// Frames kept by the profiler, and how often the overlay is refreshed
+const int profile_frames_g = 600;
+const int profile_refresh_frames_g = 30;
+// File the profiled frames are written to when the game ends
+const char *profile_file_g = "profile.csv";
+
+// Particle effects: number of particles, direction, spread, speed, cycle
+// and color
+const ParticleEffect trail_effect_g = { 1000, glm::pi<float>(), 0.13f, 1.0f, 5.0f, glm::vec3(0.01f, 0.05f, 0.9f) };
+const ParticleEffect explosion_effect_g = { 1000, glm::pi<float>(), glm::pi<float>(), 12.0f, 0.0f, glm::vec3(0.7f, 0.4f, 0.01f) };
 
-Game::Game(void)
+
+// Collision grid cells are about the size of a regular enemy
+Game::Game(void) : collision_grid_(1.0f, 4096), profiler_(profile_frames_g)
 {
     // Don't do work in the constructor, leave it for the Init() function
+    window_ = nullptr;
+    headless_ = false;
+    quit_ = false;
+    sprite_ = nullptr;
+    trail_effect_ = 0;
+    explosion_effect_ = 0;
+    tex_ = nullptr;
+    show_profile_ = false;
+    profile_key_down_ = false;
+    wave_file_ = resources_directory_g + std::string("/waves.txt");
+    num_threads_ = 0;
+    max_objects_ = max_objects_g;
+    render_thread_ = true;
+    viewport_width_ = 0;
+    viewport_height_ = 0;
+
+    // Register the update system of each object type
+    for (int type = 0; type < NumObjectTypes; type++) {
+        update_systems_[type] = &Game::UpdateObjects;
+    }
+    update_systems_[PlayerObj] = &Game::UpdatePlayers;
+    update_systems_[EnemyObj] = &Game::UpdateEnemies;
+    update_systems_[SubObj] = &Game::UpdateSubs;
+    update_systems_[BossObj] = &Game::UpdateBosses;
+    update_systems_[SharkObj] = &Game::UpdateSharks;
+    update_systems_[TurretObj] = &Game::UpdateTurrets;
+
+    // And the profiler zone it is timed in
+    for (int type = 0; type < NumObjectTypes; type++) {
+        update_zones_[type] = ProfileObjects;
+    }
+    update_zones_[PlayerObj] = ProfilePlayers;
+    update_zones_[SubObj] = ProfileSubs;
+    update_zones_[BossObj] = ProfileBosses;
+    update_zones_[SharkObj] = ProfileSharks;
+    update_zones_[TurretObj] = ProfileTurrets;
 }
 
 
@@ -74,42 +153,61 @@ void Game::Init(void)
         throw(std::runtime_error(std::string("Could not initialize the GLEW library: ") + std::string((const char *)glewGetErrorString(err))));
     }
 
-    // Set event callbacks
-    glfwSetFramebufferSizeCallback(window_, ResizeCallback);
-
     // Initialize sprite geometry
     sprite_ = new Sprite();
     sprite_->CreateGeometry();
 
-    // Initialize particle geometry
-    particles_ = new Particles();
-    particles_->CreateGeometry();
-
-    explosion_particles_ = new ExplosionParticles();
-    explosion_particles_->CreateGeometry();
-
-    tile_ = new Tile();
-    tile_->CreateGeometry();
-
-    // Initialize particle shader
-    particle_shader_.Init((resources_directory_g+std::string("/particle_vertex_shader.glsl")).c_str(), (resources_directory_g+std::string("/particle_fragment_shader.glsl")).c_str());
+    // Initialize the particle pool, with a shader for each kind of effect
+    particle_pool_.Init(resources_directory_g + std::string("/particle_vertex_shader.glsl"), resources_directory_g + std::string("/particle_fragment_shader.glsl"));
+    trail_effect_ = particle_pool_.AddEffect(trail_effect_g);
+    explosion_effect_ = particle_pool_.AddEffect(explosion_effect_g);
 
-    // Initialize sprite shader
-    sprite_shader_.Init((resources_directory_g+std::string("/sprite_vertex_shader.glsl")).c_str(), (resources_directory_g+std::string("/sprite_fragment_shader.glsl")).c_str());
+    // Initialize sprite shader, which draws batches of sprites
+    sprite_shader_.Init((resources_directory_g+std::string("/sprite_batch_vertex_shader.glsl")).c_str(), (resources_directory_g+std::string("/sprite_fragment_shader.glsl")).c_str());
+    sprite_batch_.Init(&sprite_shader_);
 
     text_shader_.Init((resources_directory_g + std::string("/sprite_vertex_shader.glsl")).c_str(), (resources_directory_g + std::string("/text_fragment_shader.glsl")).c_str());
 
     // Initialize drawing shader
     drawing_shader_.Init((resources_directory_g + std::string("/sprite_vertex_shader.glsl")).c_str(), (resources_directory_g + std::string("/drawing_fragment_shader.glsl")).c_str());
 
+    InitGameState();
+}
+
+
+void Game::InitHeadless(void)
+{
+    // No window, OpenGL context, geometry or shaders are created
+    // Game objects keep null geometry and are never rendered
+    headless_ = true;
+
+    InitGameState();
+}
+
+
+void Game::InitGameState(void)
+{
     // Initialize time
     current_time_ = 0.0;
 
+    // Timers follow the simulation, so they stop with it and step with it
+    timers_.Init(&sim_clock_, sim_time_step_g);
+
+    // Size the object stores once, so pooled spawns stay off the heap
+    // Objects rarely run more than two timers at once
+    game_objects_.Reserve(max_objects_);
+    motion_.Reserve(max_objects_);
+    to_erase_.reserve(max_objects_);
+    timers_.Reserve(2 * max_objects_);
+    expired_timers_.reserve(max_objects_);
+
     // Shooting cool down
     next_shot_ = 0.0;
+    next_torpedo_ = 0.0;
 
     lastSecond_ = -1;
     camera_position_ = glm::vec3(0.0f, 0.0f, 0.0f);
+    previous_camera_position_ = camera_position_;
     score_ = 0;
     killcount_ = 0;
     player_dead_ = false;
@@ -118,18 +216,51 @@ void Game::Init(void)
     damage_factor_ = 1;
     boss_vuln_ = false;
     mission_complete_ = false;
+
+    // Each thread sweeps projectiles into its own buffer
+    jobs_.Start(num_threads_);
+    sweep_buffers_.resize(jobs_.GetNumThreads());
+
+    // The buffers filled during a step grow to their peak on the first
+    // steps that need them; sizing them for the whole game up front keeps
+    // later steps off the heap too. An object covers at most four cells
+    // of the collision grid
+    for (int type = 0; type < NumObjectTypes; type++) {
+        archetypes_[type].reserve(max_objects_);
+    }
+    collision_grid_.Reserve(4 * max_objects_);
+    candidates_.reserve(max_objects_);
+    for (int i = 0; i < sweep_buffers_.size(); i++) {
+        sweep_buffers_[i].candidates.reserve(max_objects_);
+        sweep_buffers_[i].hits.reserve(max_objects_);
+    }
+    projectiles_.reserve(max_objects_);
+    sweep_hits_.reserve(max_objects_);
+    shark_shots_.Reserve(max_objects_);
+    sub_torpedoes_.Reserve(max_objects_);
+    events_.Reserve(max_objects_);
+    Bullet::ReservePool(max_objects_);
+    ParticleSystem::ReservePool(max_objects_);
 }
 
 
 Game::~Game()
 {
+    StopRenderThread();
+
     // Free memory for all objects
     // Only need to delete objects that are not automatically freed
     delete sprite_;
-    delete particles_;
-    for (int i = 0; i < game_objects_.size(); i++){
+    for (int i = 0; i < game_objects_.Size(); i++){
         delete game_objects_[i];
     }
+    game_objects_.Clear();
+    motion_.Clear();
+    for (int i = 0; i < profile_lines_.size(); i++) {
+        delete profile_lines_[i];
+    }
+
+    if (headless_) return;
 
     // Close window
     glfwDestroyWindow(window_);
@@ -145,14 +276,19 @@ void Game::Setup(void)
     // Load textures
     SetAllTextures();
 
+    // Load the enemy waves
+    if (!wave_file_.empty()) waves_.Load(wave_file_);
+
+    if (!headless_) InitProfileOverlay();
+
     // Setup the player object (position, texture, vertex count)
-    // Note that, in this specific implementation, the player object should always be the first object in the game object vector 
+    // The player is found through player_handle_ rather than its position in the object store
     PlayerGameObject *player = new PlayerGameObject(glm::vec3(1.0f, -1.0f, 0.0f), sprite_, &sprite_shader_, tex_[6], 0.8f, 2.0f, 10, 10);
     float pi_over_two = glm::pi<float>() / 2.0f;
     player->SetRotation(pi_over_two);
     //player->SetScale(1.0);
     player->SetType(PlayerObj);
-    game_objects_.push_back(player);
+    player_handle_ = AddGameObject(player);
 
     TextGameObject* text = new TextGameObject(camera_position_ + glm::vec3(-4.1f, -3.75f, -1.0f), sprite_, &text_shader_, tex_[10], 1.0f, 5.0f, 1);
     text->SetScale(0.5f);
@@ -160,7 +296,7 @@ void Game::Setup(void)
     text->SetVelocity(glm::vec3(0.0f, 1.0f, 0.0f));
     std::string time = std::to_string(lastSecond_);
     text->SetText("Time: " + time);
-    game_objects_.push_back(text);
+    timer_text_handle_ = AddGameObject(text);
 
     TextGameObject* text2 = new TextGameObject(camera_position_ + glm::vec3(-0.35f, -3.75f, -1.0f), sprite_, &text_shader_, tex_[10], 0.5f, 5.0f, 1);
     text2->SetScale(1.0f);
@@ -168,7 +304,7 @@ void Game::Setup(void)
     text2->SetVelocity(glm::vec3(0.0f, 1.0f, 0.0f));
     std::string health = std::to_string((player->GetHealth() / 10) * 100);
     text2->SetText("|Hull Integrity: " + health + "%");
-    game_objects_.push_back(text2);
+    health_text_handle_ = AddGameObject(text2);
 
     TextGameObject* text3 = new TextGameObject(camera_position_ + glm::vec3(3.7f, -3.75f, -1.0f), sprite_, &text_shader_, tex_[10], 0.5f, 3.35f, 1);
     text3->SetScale(1.0f);
@@ -176,55 +312,49 @@ void Game::Setup(void)
     text3->SetVelocity(glm::vec3(0.0f, 1.0f, 0.0f));
     std::string score = std::to_string(score_); 
     text3->SetText("|Score: " + score); 
-    game_objects_.push_back(text3); 
+    score_text_handle_ = AddGameObject(text3);
 
     TextGameObject* text4 = new TextGameObject(camera_position_ + glm::vec3(0.0f, 3.75f, -1.0f), sprite_, &text_shader_, tex_[17], 0.5f, 10.7f, 1);
     //text4->SetScale(0.1f);
     text4->SetType(ExplainObj);
     text4->SetVelocity(glm::vec3(0.0f, 1.0f, 0.0f));
     text4->SetText("Find Red White and Blue October.");
-    game_objects_.push_back(text4);
+    AddGameObject(text4);
     text4->SetAlive(false);
-    text4->GetDeath()->Start(10);
+    StartDeath(text4, 10);
     TextGameObject* text5 = new TextGameObject(camera_position_ + glm::vec3(0.0f, 3.25f, -1.0f), sprite_, &text_shader_, tex_[17], 0.5f, 10.7f, 1);
     //text5->SetScale(0.1f);
     text5->SetType(ExplainObj);
     text5->SetVelocity(glm::vec3(0.0f, 1.0f, 0.0f));
     text5->SetText("You'll know it when you see it.");
-    game_objects_.push_back(text5);
+    AddGameObject(text5);
     text5->SetAlive(false);
-    text5->GetDeath()->Start(10);
+    StartDeath(text5, 10);
     TextGameObject* text6 = new TextGameObject(camera_position_ + glm::vec3(0.0f, 2.75f, -1.0f), sprite_, &text_shader_, tex_[17], 0.5f, 10.7f, 1);
     //text6->SetScale(0.1f);
     text6->SetType(ExplainObj);
     text6->SetVelocity(glm::vec3(0.0f, 1.0f, 0.0f));
     text6->SetText("Destroy it, before it's too late...");
-    game_objects_.push_back(text6);
+    AddGameObject(text6);
     text6->SetAlive(false);
-    text6->GetDeath()->Start(10);
+    StartDeath(text6, 10);
 
     // Setup background
-    // In this specific implementation, the background is always the
-    // last object
-    GameObject *background = new GameObject(glm::vec3(0.0f, 0.0f, 0.0f), tile_, &sprite_shader_, tex_[8], 1.0f, 1.0f, 1);
+    // It is drawn after the other sprites, so it only fills the space they leave
+    GameObject *background = new GameObject(glm::vec3(0.0f, 0.0f, 0.0f), sprite_, &sprite_shader_, tex_[8], 1.0f, 1.0f, 1);
     background->SetScale(500.0);
+    // Repeat the water texture 10 times across
+    background->SetUVRect(glm::vec4(0.0f, 0.0f, 10.0f, 10.0f));
     background->SetType(BackgroundObj);
-    game_objects_.push_back(background);
+    background_handle_ = AddGameObject(background);
 
     // Setup particle system
-    GameObject *particles = new ParticleSystem(glm::vec3(-1.0f, 0.0f, 0.0f), particles_, &particle_shader_, tex_[4], game_objects_[0], 1.0f, 1.0f, 1);
+    GameObject *particles = new ParticleSystem(glm::vec3(-1.0f, 0.0f, 0.0f), &particle_pool_, trail_effect_, tex_[4], player->GetHandle(), 1.0f, 1.0f, 1);
     particles->SetScale(0.2);
     particles->SetRotation(-pi_over_two);
     particles->SetType(PSystemObj);
-    game_objects_.push_back(particles);
-}
-
-
-void Game::ResizeCallback(GLFWwindow* window, int width, int height)
-{
-
-    // Set OpenGL viewport based on framebuffer width and height
-    glViewport(0, 0, width, height);
+    AddGameObject(particles);
+    player->SetParticles(particles->GetHandle());
 }
 
 
@@ -273,45 +403,449 @@ void Game::SetAllTextures(void)
     // Get number of declared textures
     int num_textures = sizeof(texture) / sizeof(char *);
     // Allocate a buffer for all texture references
-    tex_ = new GLuint[num_textures];
-    glGenTextures(num_textures, tex_);
+    tex_ = new TextureRegion[num_textures];
+    if (headless_) {
+        // Nothing is drawn: objects only need a texture reference
+        return;
+    }
     // Load each texture
+    // Sprite textures are packed into the atlas, so sprites can be drawn
+    // together; the water repeats, the fonts are read by the text shader
+    // and the orb by the particle shader, so those keep their own texture
+    std::vector<int> atlas_index(num_textures, -1);
     for (int i = 0; i < num_textures; i++){
-        if (i == 8) {
-            SetTexture(tex_[i], (resources_directory_g + std::string(texture[i])).c_str(), true);
+        bool standalone = (i == 4 || i == 8 || i == 10 || i == 17);
+        if (standalone) {
+            GLuint w;
+            glGenTextures(1, &w);
+            SetTexture(w, (resources_directory_g + std::string(texture[i])).c_str(), i == 8);
+            tex_[i] = TextureRegion(w);
         }
-        else SetTexture(tex_[i], (resources_directory_g+std::string(texture[i])).c_str(), false);
+        else atlas_index[i] = AddToAtlas((resources_directory_g+std::string(texture[i])).c_str());
+    }
+    atlas_.Build();
+    for (int i = 0; i < num_textures; i++){
+        if (atlas_index[i] >= 0) tex_[i] = atlas_.GetRegion(atlas_index[i]);
     }
     // Set first texture in the array as default
-    glBindTexture(GL_TEXTURE_2D, tex_[0]);
+    glBindTexture(GL_TEXTURE_2D, tex_[0].texture);
+
+    // Textures were bound without the render state cache
+    RenderState::Reset();
+}
+
+
+int Game::AddToAtlas(const char *fname)
+{
+    int width, height;
+    unsigned char* image = SOIL_load_image(fname, &width, &height, 0, SOIL_LOAD_RGBA);
+    if (!image){
+        std::cout << "Cannot load texture " << fname << std::endl;
+        return -1;
+    }
+    int index = atlas_.Add(image, width, height);
+    SOIL_free_image_data(image);
+    return index;
 }
 
 
 void Game::MainLoop(void)
 {
+    // The OpenGL context is current on one thread at a time, so the render
+    // thread takes it until the game ends
+    if (render_thread_) {
+        glfwMakeContextCurrent(NULL);
+        renderer_ = std::thread(&Game::RenderLoop, this);
+    }
+
     // Loop while the user did not close the window
     double last_time = glfwGetTime();
+    double accumulator = 0.0;
     while (!glfwWindowShouldClose(window_)){
 
         // Calculate delta time
         double current_time = glfwGetTime();
         double delta_time = current_time - last_time;
         last_time = current_time;
+        accumulator += delta_time;
 
         // Update window events like input handling
         glfwPollEvents();
 
-        // Handle user input
-        HandleControls(delta_time);
+        // Run as many fixed simulation steps as the elapsed time allows
+        int steps = 0;
+        while (accumulator >= sim_time_step_g && steps < max_sim_steps_g && !quit_) {
+            SaveState();
+            sim_clock_.Advance(sim_time_step_g);
+
+            // Handle user input
+            {
+                ProfileScope scope(profiler_, ProfileControls);
+                HandleControls(sim_time_step_g);
+            }
+
+            // Update all the game objects
+            Update(sim_time_step_g);
+
+            accumulator -= sim_time_step_g;
+            steps++;
+        }
+
+        // Drop the time we could not catch up on, so a long stall does
+        // not make the following frames run even more steps
+        if (accumulator >= sim_time_step_g) {
+            accumulator = fmod(accumulator, sim_time_step_g);
+        }
+
+        // Hand the state after the steps to the renderer
+        PublishSnapshot(current_time, accumulator);
+
+        if (render_thread_) {
+            // Wait for the next step while the renderer draws; it blends
+            // towards the last step by itself
+            std::this_thread::sleep_for(std::chrono::duration<double>(sim_time_step_g - accumulator));
+        }
+        else {
+            // Render all the game objects, between the last two simulation states
+            PresentFrame();
+        }
+
+        profiler_.Add(ProfileRender, snapshots_.TakeDrawTime());
+        profiler_.EndFrame();
+        if (show_profile_ && profiler_.GetNumFrames() % profile_refresh_frames_g == 0) {
+            UpdateProfileOverlay();
+        }
+    }
+
+    StopRenderThread();
+    profiler_.WriteCSV(profile_file_g);
+}
+
+
+void Game::PublishSnapshot(double time, double lag)
+{
+    RenderSnapshot &snapshot = snapshots_.GetBack();
+    snapshot.Clear();
+    snapshot.time = time;
+    snapshot.lag = lag;
+    snapshot.previous_camera_position = previous_camera_position_;
+    snapshot.camera_position = camera_position_;
+    glfwGetWindowSize(window_, &snapshot.window_width, &snapshot.window_height);
+    glfwGetFramebufferSize(window_, &snapshot.framebuffer_width, &snapshot.framebuffer_height);
+
+    // Records follow the order of the game objects, so the index of a
+    // parent is the index of its record
+    for (int i = 0; i < game_objects_.Size(); i++) {
+        GameObject* object = game_objects_[i];
+        object->Snapshot(snapshot);
+        snapshot.records.back().parent = game_objects_.GetIndex(object->GetParent());
+    }
+
+    // The overlay lines are placed around the camera when drawn
+    snapshot.overlay_start = (int)snapshot.records.size();
+    snapshot.show_profile = show_profile_;
+    if (show_profile_) {
+        for (int i = 0; i < profile_lines_.size(); i++) {
+            profile_lines_[i]->Snapshot(snapshot);
+        }
+    }
+
+    snapshots_.Publish();
+}
+
+
+bool Game::PresentFrame(void)
+{
+    const RenderSnapshot *snapshot = snapshots_.Acquire();
+    if (snapshot == nullptr) return false;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    Render(*snapshot, glfwGetTime());
+    std::chrono::duration<double> draw_time = std::chrono::steady_clock::now() - start;
+
+    // The swap can wait for the display, so the game can publish again
+    // before it
+    snapshots_.Release(draw_time.count());
+
+    // Push buffer drawn in the background onto the display
+    glfwSwapBuffers(window_);
+    return true;
+}
+
+
+void Game::RenderLoop(void)
+{
+    // Draw the newest snapshot over and over, blending further towards
+    // its last step, until the game ends
+    glfwMakeContextCurrent(window_);
+    while (PresentFrame()) {
+    }
+    glfwMakeContextCurrent(NULL);
+}
+
+
+void Game::StopRenderThread(void)
+{
+    if (!renderer_.joinable()) return;
+    snapshots_.Close();
+    renderer_.join();
+    glfwMakeContextCurrent(window_);
+}
+
+
+void Game::RunHeadless(double duration, double time_step)
+{
+    // Simulate without input or rendering, as fast as the CPU allows
+    double start_time = sim_clock_.GetTime();
+    long ticks = 0;
+    std::chrono::steady_clock::time_point wall_start = std::chrono::steady_clock::now();
+    while (!quit_ && sim_clock_.GetTime() - start_time < duration) {
+        Step(time_step);
+        ticks++;
+    }
+    std::chrono::duration<double> wall_time = std::chrono::steady_clock::now() - wall_start;
+
+    std::cout << "Simulated " << sim_clock_.GetTime() - start_time << " s in " << ticks << " ticks (" 
+        << wall_time.count() << " s wall time)" << std::endl;
+    std::cout << "Score: " << score_ << ", kills: " << killcount_ << ", objects: " << game_objects_.Size() << std::endl;
+
+    profiler_.WriteCSV(profile_file_g);
+}
+
+
+void Game::Step(double time_step)
+{
+    sim_clock_.Advance(time_step);
+    Update(time_step);
+    profiler_.EndFrame();
+}
+
+
+void Game::SetPlayerInvincible(void)
+{
+    // No power-up timer is started, so it never wears off
+    GameObject *player = GetGameObject(player_handle_);
+    if (player != nullptr) player->PowerUp();
+}
+
+
+// Mix the bytes of a value into an FNV-1a hash
+template <typename T>
+static void HashValue(unsigned long long &hash, const T &value)
+{
+    const unsigned char *bytes = reinterpret_cast<const unsigned char*>(&value);
+    for (int i = 0; i < sizeof(T); i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+}
+
+
+unsigned long long Game::GetChecksum(void) const
+{
+    unsigned long long hash = 14695981039346656037ull;
+    HashValue(hash, killcount_);
+    HashValue(hash, turret_killcount_);
+    HashValue(hash, score_);
+    HashValue(hash, camera_position_);
+    for (int i = 0; i < game_objects_.Size(); i++) {
+        const GameObject *object = game_objects_[i];
+        HashValue(hash, object->GetType());
+        HashValue(hash, object->GetPosition());
+        HashValue(hash, object->GetVelocity());
+        HashValue(hash, object->GetRotation());
+        HashValue(hash, object->GetHealth());
+        HashValue(hash, object->GetAlive());
+        HashValue(hash, object->GetDying());
+    }
+    return hash;
+}
+
+
+int Game::GetNumAwake(ObjectType type) const
+{
+    int count = 0;
+    for (int i = 0; i < game_objects_.Size(); i++) {
+        if (game_objects_[i]->GetType() == type && game_objects_[i]->GetAwake()) count++;
+    }
+    return count;
+}
+
+
+void Game::Quit(void)
+{
+    quit_ = true;
+    if (window_ != nullptr) glfwSetWindowShouldClose(window_, true);
+}
+
+
+// Types whose only movement is a constant velocity; the motion store
+// integrates them all at once instead of one Update() at a time
+static bool MovesLinearly(ObjectType type)
+{
+    switch (type) {
+        case BulletObj:
+        case TorpedoObj:
+        case SharkBulletObj:
+        case SubTorpedoObj:
+        case ItemObj:
+        case BackgroundObj:
+        case TimerObj:
+        case HealthObj:
+        case ScoreObj:
+        case ExplainObj:
+            return true;
+        default:
+            return false;
+    }
+}
+
+
+// Types that sleep outside the activation band
+// Attached objects of any type sleep and wake with their parent instead
+static bool SleepsOutOfBand(ObjectType type)
+{
+    switch (type) {
+        case EnemyObj:
+        case MineObj:
+        case SharkObj:
+        case SubObj:
+        case BossObj:
+        case ItemObj:
+        case PSystemObj:
+            return true;
+        default:
+            return false;
+    }
+}
+
+
+static bool IsProjectile(ObjectType type)
+{
+    return type == BulletObj || type == TorpedoObj || type == SharkBulletObj || type == SubTorpedoObj;
+}
+
+
+// Whether a projectile is out of the view and moving away from it
+// Projectiles fly straight and the view scrolls at a constant speed, so
+// such a projectile never comes back into view
+static bool HasLeftView(const GameObject *object, const glm::vec3 &camera_position)
+{
+    glm::vec3 offset = object->GetPosition() - camera_position;
+    glm::vec3 velocity = object->GetVelocity() - glm::vec3(0.0f, scroll_speed_g, 0.0f);
+    glm::vec2 limit = view_half_size_g + glm::vec2(projectile_margin_g);
+    return (offset.x < -limit.x && velocity.x <= 0.0f) || (offset.x > limit.x && velocity.x >= 0.0f) ||
+        (offset.y < -limit.y && velocity.y <= 0.0f) || (offset.y > limit.y && velocity.y >= 0.0f);
+}
+
+
+// Layer each type of object is drawn in
+static RenderLayer GetRenderLayer(ObjectType type)
+{
+    switch (type) {
+        case PlayerObj:
+            return PlayerLayer;
+        case BackgroundObj:
+            return BackgroundLayer;
+        case TimerObj:
+        case HealthObj:
+        case ScoreObj:
+        case ExplainObj:
+            return HudLayer;
+        case PSystemObj:
+        case PSystemExplosionObj:
+            return EffectsLayer;
+        default:
+            return SpriteLayer;
+    }
+}
+
+
+Handle Game::AddGameObject(GameObject *object)
+{
+    Handle handle = game_objects_.Insert(object);
+    object->SetHandle(handle);
+    if (MovesLinearly(object->GetType())) {
+        object->SetMotionIndex(motion_.Add(object, object->GetPosition(), object->GetVelocity()));
+    }
+    if (object->GetLifespan() > 0.0) {
+        StartTimer(object, LifespanTimer, object->GetLifespan());
+    }
+    return handle;
+}
+
+
+void Game::RemoveGameObject(const Handle &handle)
+{
+    GameObject *object = GetGameObject(handle);
+    if (object == nullptr) return;
+
+    // The last object in the motion store takes this one's place
+    if (object->GetMotionIndex() >= 0) {
+        GameObject *moved = motion_.Remove(object->GetMotionIndex());
+        if (moved != nullptr) moved->SetMotionIndex(object->GetMotionIndex());
+    }
+    // Timers left running would expire on a stale handle
+    for (int kind = 0; kind < NumObjectTimers; kind++) {
+        timers_.Cancel(object->GetTimer((ObjectTimer)kind));
+    }
+    game_objects_.Remove(handle);
+    delete object;
+}
 
-        // Update all the game objects
-        Update(delta_time);
 
-        // Render all the game objects
-        Render(delta_time);
+void Game::StartTimer(GameObject *object, ObjectTimer kind, double delay)
+{
+    timers_.Cancel(object->GetTimer(kind));
+    TimerEvent event;
+    event.object = object->GetHandle();
+    event.kind = kind;
+    object->SetTimer(kind, timers_.Start(delay, event));
+}
+
 
-        // Push buffer drawn in the background onto the display
-        glfwSwapBuffers(window_);
+void Game::StartDeath(GameObject *object, double delay)
+{
+    object->SetDying(true);
+    StartTimer(object, DeathTimer, delay);
+}
+
+
+void Game::ExpireTimer(const TimerEvent &event)
+{
+    GameObject *object = GetGameObject(event.object);
+    if (object == nullptr) return;
+    object->SetTimer((ObjectTimer)event.kind, Handle());
+
+    switch (event.kind) {
+        case DeathTimer:
+            object->SetDying(false);
+            break;
+        case PowerUpTimer:
+            object->SetInvincible(false);
+            break;
+        case LifespanTimer:
+            object->SetAlive(false);
+            break;
+        case ShotTimer:
+            object->SetShotReady(true);
+            break;
+    }
+}
+
+
+GameObject *Game::GetGameObject(const Handle &handle)
+{
+    GameObject **object = game_objects_.Get(handle);
+    if (object == nullptr) return nullptr;
+    return *object;
+}
+
+
+void Game::SaveState(void)
+{
+    previous_camera_position_ = camera_position_;
+    for (int i = 0; i < game_objects_.Size(); i++) {
+        game_objects_[i]->SaveState();
     }
 }
 
@@ -319,7 +853,8 @@ void Game::MainLoop(void)
 void Game::HandleControls(double delta_time)
 {
     // Get player game object
-    GameObject *player = game_objects_[0];
+    GameObject *player = GetGameObject(player_handle_);
+    if (player == nullptr) return;
     // Get current position and angle
     glm::vec3 curpos = player->GetPosition();
     float angle = player->GetRotation();
@@ -355,16 +890,22 @@ void Game::HandleControls(double delta_time)
     if (glfwGetKey(window_, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
         glfwSetWindowShouldClose(window_, true);
     }
+    // Show or hide the profiler overlay when F3 goes down
+    bool profile_key = glfwGetKey(window_, GLFW_KEY_F3) == GLFW_PRESS;
+    if (profile_key && !profile_key_down_) {
+        show_profile_ = !show_profile_;
+        if (show_profile_) UpdateProfileOverlay();
+    }
+    profile_key_down_ = profile_key;
     if (glfwGetMouseButton(window_, GLFW_MOUSE_BUTTON_1) == GLFW_PRESS) {
         if (player->GetAlive()) {
             if (current_time_ > next_shot_) {
-                GameObject* player = game_objects_[0];
                 Bullet* bullet = new Bullet(player->GetPosition(), sprite_, &sprite_shader_, tex_[9], 1.0f, 1.0f, 1);
                 bullet->SetRotation(player->GetRotation() - glm::pi<float>() / 2.0);
                 bullet->SetVelocity(18.0f * player->GetBearing());
                 //bullet->SetScale(0.5f);
                 bullet->SetOrigin(player->GetPosition());
-                game_objects_.insert(game_objects_.begin() + 1, bullet);
+                AddGameObject(bullet);
                 next_shot_ = current_time_ + 0.25;
             }
         }
@@ -372,23 +913,19 @@ void Game::HandleControls(double delta_time)
     if (glfwGetMouseButton(window_, GLFW_MOUSE_BUTTON_2) == GLFW_PRESS) {
         if (player->GetAlive()) {
             if (current_time_ > next_torpedo_) {
-                GameObject* player = game_objects_[0];
                 Bullet* torpedo = new Bullet(player->GetPosition(), sprite_, &sprite_shader_, tex_[14], 1.0f, 1.0f, 1);
                 torpedo->SetRotation(glm::pi<float>() / 2.0);
                 torpedo->SetVelocity(8.0f * player->GetBearing());
                 //bullet->SetScale(0.5f);
                 torpedo->SetOrigin(player->GetPosition());
                 torpedo->SetType(TorpedoObj);
-                game_objects_.insert(game_objects_.begin() + 1, torpedo);
+                AddGameObject(torpedo);
 
-                GameObject* particles = new ParticleSystem(glm::vec3(-0.6f, 0.0f, 0.0f), particles_, &particle_shader_, tex_[4], torpedo, 1.0f, 1.0f, 1);
+                GameObject* particles = new ParticleSystem(glm::vec3(-0.6f, 0.0f, 0.0f), &particle_pool_, trail_effect_, tex_[4], torpedo->GetHandle(), 1.0f, 1.0f, 1);
                 particles->SetScale(0.1);
                 particles->SetRotation(-glm::pi<float>() / 2.0);
-                torpedo->SetParticles(particles);
-
-
-
-                game_objects_.push_back(particles);
+                AddGameObject(particles);
+                torpedo->SetParticles(particles->GetHandle());
                 next_torpedo_ = current_time_ + 5.0;
             }
         }
@@ -400,922 +937,838 @@ void Game::HandleControls(double delta_time)
 void Game::Update(double delta_time)
 {
     // hold player for certain purposes
-    PlayerGameObject* player = dynamic_cast<PlayerGameObject*>(game_objects_[0]);
+    PlayerGameObject* player = static_cast<PlayerGameObject*>(GetGameObject(player_handle_));
+    if (player == nullptr) return;
+    ProfileScope update_scope(profiler_, ProfileUpdate);
     // Update time
     current_time_ += delta_time;
 
+    // Apply the timers that expired by this step, in the order they expired
+    {
+        ProfileScope scope(profiler_, ProfileTimers);
+        expired_timers_.clear();
+        timers_.Advance(expired_timers_);
+        for (int i = 0; i < expired_timers_.size(); i++) {
+            ExpireTimer(expired_timers_[i]);
+        }
+    }
+
     score_ = (killcount_ * 100);
 
-    std::vector<GameObject*> to_erase;
+    to_erase_.clear();
 
     seconds_ = (int)(current_time_ + 0.5);
     if (seconds_ > lastSecond_) {
         lastSecond_ = seconds_;
-        if (fmod(lastSecond_, 5) == 0 && lastSecond_ > 0) {
-            float pi_over_two = glm::pi<float>() / 2.0f;
-            // This is where enemy spawning waves are controlled
-            if (lastSecond_ == 10) {
-                MineEnemyObject* mine1 = new MineEnemyObject(camera_position_ + glm::vec3(-1.0f, 4.0f, 0.0f), sprite_, &sprite_shader_, tex_[11], 1.0f, 1.0f, 2, camera_position_ + glm::vec3(-1.0f, 4.0f, 0.0f));
-                mine1->SetVelocity(glm::vec3(0.0, 1.0, 0.0));
-                mine1->SetType(MineObj);
-                game_objects_.insert(game_objects_.begin() + 1, mine1);
-                
-                MineEnemyObject* mine2 = new MineEnemyObject(camera_position_ + glm::vec3(0.0f, 5.0f, 0.0f), sprite_, &sprite_shader_, tex_[11], 1.0f, 1.0f, 2, camera_position_ + glm::vec3(0.0f, 5.0f, 0.0f));
-                mine2->SetVelocity(glm::vec3(0.0, 1.0, 0.0));
-                mine2->SetType(MineObj);
-                game_objects_.insert(game_objects_.begin() + 1, mine2);
-                
-            }
-            else if (lastSecond_ == 20) {
-                MineEnemyObject* mine1 = new MineEnemyObject(camera_position_ + glm::vec3(-1.5f, 4.5f, 0.0f), sprite_, &sprite_shader_, tex_[11], 1.0f, 1.0f, 2, camera_position_ + glm::vec3(-1.0f, 4.0f, 0.0f)); 
-                mine1->SetVelocity(glm::vec3(0.0, 1.0, 0.0)); 
-                mine1->SetType(MineObj); 
-                game_objects_.insert(game_objects_.begin() + 1, mine1); 
-
-                MineEnemyObject* mine2 = new MineEnemyObject(camera_position_ + glm::vec3(0.0f, 5.0f, 0.0f), sprite_, &sprite_shader_, tex_[11], 1.0f, 1.0f, 2, camera_position_ + glm::vec3(0.0f, 5.0f, 0.0f));
-                mine2->SetVelocity(glm::vec3(0.0, 1.0, 0.0));
-                mine2->SetType(MineObj);
-                game_objects_.insert(game_objects_.begin() + 1, mine2);
-
-                MineEnemyObject* mine3 = new MineEnemyObject(camera_position_ + glm::vec3(2.0f, 5.5f, 0.0f), sprite_, &sprite_shader_, tex_[11], 1.0f, 1.0f, 2, camera_position_ + glm::vec3(-4.0f, 5.5f, 0.0f));
-                mine3->SetVelocity(glm::vec3(0.0, 1.0, 0.0));
-                mine3->SetType(MineObj);
-                game_objects_.insert(game_objects_.begin() + 1, mine3);
-
-                MineEnemyObject* mine4 = new MineEnemyObject(camera_position_ + glm::vec3(1.0f, 6.0f, 0.0f), sprite_, &sprite_shader_, tex_[11], 1.0f, 1.0f, 2, camera_position_ + glm::vec3(1.0f, 6.0f, 0.0f));
-                mine4->SetVelocity(glm::vec3(0.0, 1.0, 0.0));
-                mine4->SetType(MineObj);
-                game_objects_.insert(game_objects_.begin() + 1, mine4);
-
-                MineEnemyObject* mine5 = new MineEnemyObject(camera_position_ + glm::vec3(-2.5f, 6.0f, 0.0f), sprite_, &sprite_shader_, tex_[11], 1.0f, 1.0f, 2, camera_position_ + glm::vec3(-2.5f, 6.0f, 0.0f));
-                mine5->SetVelocity(glm::vec3(0.0, 1.0, 0.0));
-                mine5->SetType(MineObj);
-                game_objects_.insert(game_objects_.begin() + 1, mine5);
-
-                MineEnemyObject* mine6 = new MineEnemyObject(camera_position_ + glm::vec3(2.5f, 5.5f, 0.0f), sprite_, &sprite_shader_, tex_[11], 1.0f, 1.0f, 2, camera_position_ + glm::vec3(2.5f, 5.5f, 0.0f));
-                mine6->SetVelocity(glm::vec3(0.0, 1.0, 0.0));
-                mine6->SetType(MineObj);
-                game_objects_.insert(game_objects_.begin() + 1, mine6);
-            }
-            else if (lastSecond_ == 30) {
-                SubEnemyObject* sub1 = new SubEnemyObject(camera_position_ + glm::vec3(-2.0f, 6.0f, 0.0f), sprite_, &sprite_shader_, tex_[13], 0.6f, 1.8f, 5);
-                sub1->SetTarget(player);
-                sub1->SetRotation(3* pi_over_two);
-                sub1->SetType(SubObj);
-                game_objects_.insert(game_objects_.begin() + 1, sub1);
-
-                SubEnemyObject* sub2 = new SubEnemyObject(camera_position_ + glm::vec3(2.0f, 6.0f, 0.0f), sprite_, &sprite_shader_, tex_[13], 0.6f, 1.8f, 5);
-                sub2->SetTarget(player);
-                sub2->SetRotation(3* pi_over_two);
-                sub2->SetType(SubObj);
-                game_objects_.insert(game_objects_.begin() + 1, sub2);
-
-            }
-            else if (lastSecond_ == 40) {
-                SubEnemyObject* sub1 = new SubEnemyObject(camera_position_ + glm::vec3(-2.0f, 6.0f, 0.0f), sprite_, &sprite_shader_, tex_[13], 0.6f, 1.8f, 5);
-                sub1->SetTarget(player);
-                sub1->SetRotation(3 * pi_over_two);
-                sub1->SetType(SubObj);
-                game_objects_.insert(game_objects_.begin() + 1, sub1);
-
-                SubEnemyObject* sub2 = new SubEnemyObject(camera_position_ + glm::vec3(2.0f, 6.0f, 0.0f), sprite_, &sprite_shader_, tex_[13], 0.6f, 1.8f, 5);
-                sub2->SetTarget(player);
-                sub2->SetRotation(3 * pi_over_two);
-                sub2->SetType(SubObj);
-                game_objects_.insert(game_objects_.begin() + 1, sub2);
-
-                MineEnemyObject* mine1 = new MineEnemyObject(camera_position_ + glm::vec3(-1.5f, 4.5f, 0.0f), sprite_, &sprite_shader_, tex_[11], 1.0f, 1.0f, 2, camera_position_ + glm::vec3(-1.0f, 4.0f, 0.0f));
-                mine1->SetVelocity(glm::vec3(0.0, 1.0, 0.0));
-                mine1->SetType(MineObj);
-                game_objects_.insert(game_objects_.begin() + 1, mine1);
-
-                MineEnemyObject* mine2 = new MineEnemyObject(camera_position_ + glm::vec3(0.0f, 5.0f, 0.0f), sprite_, &sprite_shader_, tex_[11], 1.0f, 1.0f, 2, camera_position_ + glm::vec3(0.0f, 5.0f, 0.0f));
-                mine2->SetVelocity(glm::vec3(0.0, 1.0, 0.0));
-                mine2->SetType(MineObj);
-                game_objects_.insert(game_objects_.begin() + 1, mine2);
-
-                MineEnemyObject* mine3 = new MineEnemyObject(camera_position_ + glm::vec3(2.0f, 5.5f, 0.0f), sprite_, &sprite_shader_, tex_[11], 1.0f, 1.0f, 2, camera_position_ + glm::vec3(2.0f, 5.5f, 0.0f));
-                mine3->SetVelocity(glm::vec3(0.0, 1.0, 0.0));
-                mine3->SetType(MineObj);
-                game_objects_.insert(game_objects_.begin() + 1, mine3);
-            }
-            else if (lastSecond_ == 55) {
-
-                MineEnemyObject* mine1 = new MineEnemyObject(camera_position_ + glm::vec3(-1.5f, 5.0f, 0.0f), sprite_, &sprite_shader_, tex_[11], 1.0f, 1.0f, 2, camera_position_ + glm::vec3(-1.5f, 5.0f, 0.0f));
-                mine1->SetVelocity(glm::vec3(0.0, 1.0, 0.0));
-                mine1->SetType(MineObj);
-                game_objects_.insert(game_objects_.begin() + 1, mine1);
-                
-                MineEnemyObject* mine2 = new MineEnemyObject(camera_position_ + glm::vec3(1.5f, 5.0f, 0.0f), sprite_, &sprite_shader_, tex_[11], 1.0f, 1.0f, 2, camera_position_ + glm::vec3(1.5f, 5.0f, 0.0f));
-                mine2->SetVelocity(glm::vec3(0.0, 1.0, 0.0));
-                mine2->SetType(MineObj);
-                game_objects_.insert(game_objects_.begin() + 1, mine2);
-
-                MineEnemyObject* mine3 = new MineEnemyObject(camera_position_ + glm::vec3(0.0f, 5.0f, 0.0f), sprite_, &sprite_shader_, tex_[11], 1.0f, 1.0f, 2, camera_position_ + glm::vec3(0.0f, 5.0f, 0.0f));
-                mine3->SetVelocity(glm::vec3(0.0, 1.0, 0.0));
-                mine3->SetType(MineObj);
-                game_objects_.insert(game_objects_.begin() + 1, mine3);
-
-                SubEnemyObject* sub1 = new SubEnemyObject(camera_position_ + glm::vec3(-3.0f, 7.5f, 0.0f), sprite_, &sprite_shader_, tex_[13], 0.6f, 1.8f, 5);
-                sub1->SetTarget(player);
-                sub1->SetRotation(3 * pi_over_two);
-                sub1->SetType(SubObj);
-                game_objects_.insert(game_objects_.begin() + 1, sub1);
-
-                SubEnemyObject* sub2 = new SubEnemyObject(camera_position_ + glm::vec3(0.0f, 7.0f, 0.0f), sprite_, &sprite_shader_, tex_[13], 0.6f, 1.8f, 5);
-                sub2->SetTarget(player);
-                sub2->SetRotation(3 * pi_over_two);
-                sub2->SetType(SubObj);
-                game_objects_.insert(game_objects_.begin() + 1, sub2);
-
-                SubEnemyObject* sub3 = new SubEnemyObject(camera_position_ + glm::vec3(2.0f, 7.5f, 0.0f), sprite_, &sprite_shader_, tex_[13], 0.6f, 1.8f, 5);
-                sub3->SetTarget(player);
-                sub3->SetRotation(3 * pi_over_two);
-                sub3->SetType(SubObj);
-                game_objects_.insert(game_objects_.begin() + 1, sub3);
-
-            }
-            else if (lastSecond_ == 70) {
-                SharkEnemyObject* shark1 = new SharkEnemyObject(camera_position_ + glm::vec3(3.0f, 6.0f, 0.0f), sprite_, &sprite_shader_, tex_[12], 1.0f, 1.0f, 7);
-                shark1->SetTarget(player);
-                shark1->SetScale(1.5);
-                shark1->SetType(SharkObj);
-                game_objects_.insert(game_objects_.begin() + 1, shark1);
-                
-                SharkEnemyObject* shark2 = new SharkEnemyObject(camera_position_ + glm::vec3(-3.0f, 6.0f, 0.0f), sprite_, &sprite_shader_, tex_[12], 1.0f, 1.0f, 7);
-                shark2->SetTarget(player);
-                shark2->SetType(SharkObj);
-                shark2->SetScale(1.5);
-                game_objects_.insert(game_objects_.begin() + 1, shark2);
-
-                ItemGameObject* upgrade = new ItemGameObject(camera_position_ + glm::vec3(0.0f, 1.0f, 0.0f), sprite_, &sprite_shader_, tex_[22], 1.0f, 1.0f, 1); 
-                upgrade->SetItemType(DamageUpgrade); 
-                upgrade->SetScale(1.25); 
-                game_objects_.insert(game_objects_.begin() + 1, upgrade);
-            }
-            else if (lastSecond_ == 75) {
-                MineEnemyObject* mine1 = new MineEnemyObject(camera_position_ + glm::vec3(-4.0f, 5.0f, 0.0f), sprite_, &sprite_shader_, tex_[11], 1.0f, 1.0f, 2, camera_position_ + glm::vec3(-1.5f, 5.0f, 0.0f));
-                mine1->SetVelocity(glm::vec3(0.0, 1.0, 0.0));
-                mine1->SetType(MineObj);
-                game_objects_.insert(game_objects_.begin() + 1, mine1);
-
-                MineEnemyObject* mine2 = new MineEnemyObject(camera_position_ + glm::vec3(-3.0f, 5.0f, 0.0f), sprite_, &sprite_shader_, tex_[11], 1.0f, 1.0f, 2, camera_position_ + glm::vec3(-3.0f, 5.0f, 0.0f));
-                mine2->SetVelocity(glm::vec3(0.0, 1.0, 0.0));
-                mine2->SetType(MineObj);
-                game_objects_.insert(game_objects_.begin() + 1, mine2);
-
-                MineEnemyObject* mine3 = new MineEnemyObject(camera_position_ + glm::vec3(-1.5f, 5.0f, 0.0f), sprite_, &sprite_shader_, tex_[11], 1.0f, 1.0f, 2, camera_position_ + glm::vec3(-4.0f, 5.0f, 0.0f));
-                mine3->SetVelocity(glm::vec3(0.0, 1.0, 0.0));
-                mine3->SetType(MineObj);
-                game_objects_.insert(game_objects_.begin() + 1, mine3);
-
-                MineEnemyObject* mine4 = new MineEnemyObject(camera_position_ + glm::vec3(0.0f, 5.0f, 0.0f), sprite_, &sprite_shader_, tex_[11], 1.0f, 1.0f, 2, camera_position_ + glm::vec3(0.0f, 5.0f, 0.0f));
-                mine4->SetVelocity(glm::vec3(0.0, 1.0, 0.0));
-                mine4->SetType(MineObj);
-                game_objects_.insert(game_objects_.begin() + 1, mine4);
-
-                MineEnemyObject* mine5 = new MineEnemyObject(camera_position_ + glm::vec3(1.5f, 5.0f, 0.0f), sprite_, &sprite_shader_, tex_[11], 1.0f, 1.0f, 2, camera_position_ + glm::vec3(1.5f, 5.0f, 0.0f));
-                mine5->SetVelocity(glm::vec3(0.0, 1.0, 0.0));
-                mine5->SetType(MineObj);
-                game_objects_.insert(game_objects_.begin() + 1, mine5);
-
-                MineEnemyObject* mine6 = new MineEnemyObject(camera_position_ + glm::vec3(3.0f, 5.0f, 0.0f), sprite_, &sprite_shader_, tex_[11], 1.0f, 1.0f, 2, camera_position_ + glm::vec3(3.0f, 5.0f, 0.0f));
-                mine6->SetVelocity(glm::vec3(0.0, 1.0, 0.0));
-                mine6->SetType(MineObj);
-                game_objects_.insert(game_objects_.begin() + 1, mine6);
-
-                MineEnemyObject* mine7 = new MineEnemyObject(camera_position_ + glm::vec3(4.0f, 5.0f, 0.0f), sprite_, &sprite_shader_, tex_[11], 1.0f, 1.0f, 2, camera_position_ + glm::vec3(4.0f, 5.0f, 0.0f));
-                mine7->SetVelocity(glm::vec3(0.0, 1.0, 0.0));
-                mine7->SetType(MineObj);
-                game_objects_.insert(game_objects_.begin() + 1, mine7);
-
-                SubEnemyObject* sub1 = new SubEnemyObject(camera_position_ + glm::vec3(-3.0f, 7.5f, 0.0f), sprite_, &sprite_shader_, tex_[13], 0.6f, 1.8f, 5);
-                sub1->SetTarget(player);
-                sub1->SetRotation(3 * pi_over_two);
-                sub1->SetType(SubObj);
-                game_objects_.insert(game_objects_.begin() + 1, sub1);
-
-                SubEnemyObject* sub2 = new SubEnemyObject(camera_position_ + glm::vec3(0.0f, 7.0f, 0.0f), sprite_, &sprite_shader_, tex_[13], 0.6f, 1.8f, 5);
-                sub2->SetTarget(player);
-                sub2->SetRotation(3 * pi_over_two);
-                sub2->SetType(SubObj);
-                game_objects_.insert(game_objects_.begin() + 1, sub2);
-
-                SubEnemyObject* sub3 = new SubEnemyObject(camera_position_ + glm::vec3(2.0f, 7.5f, 0.0f), sprite_, &sprite_shader_, tex_[13], 0.6f, 1.8f, 5);
-                sub3->SetTarget(player);
-                sub3->SetRotation(3 * pi_over_two);
-                sub3->SetType(SubObj);
-                game_objects_.insert(game_objects_.begin() + 1, sub3);
-
-                SubEnemyObject* sub4 = new SubEnemyObject(camera_position_ + glm::vec3(4.0f, 7.5f, 0.0f), sprite_, &sprite_shader_, tex_[13], 0.6f, 1.8f, 5);
-                sub4->SetTarget(player);
-                sub4->SetRotation(3 * pi_over_two);
-                sub4->SetType(SubObj);
-                game_objects_.insert(game_objects_.begin() + 1, sub4);
-
-                ItemGameObject* repairs = new ItemGameObject(camera_position_ + glm::vec3(0.0f, 1.0f, 0.0f), sprite_, &sprite_shader_, tex_[20], 1.0f, 1.0f, 1);
-                repairs->SetItemType(RepairKit);
-                repairs->SetScale(0.75);
-                game_objects_.insert(game_objects_.begin() + 1, repairs);
-            }
-            else if (lastSecond_ == 95) {
-                SubEnemyObject* sub1 = new SubEnemyObject(camera_position_ + glm::vec3(3.5f, 7.5f, 0.0f), sprite_, &sprite_shader_, tex_[13], 0.6f, 1.8f, 5);
-                sub1->SetTarget(player);
-                sub1->SetRotation(3 * pi_over_two);
-                sub1->SetType(SubObj);
-                game_objects_.insert(game_objects_.begin() + 1, sub1);
-
-                SubEnemyObject* sub2 = new SubEnemyObject(camera_position_ + glm::vec3(-3.5f, 7.0f, 0.0f), sprite_, &sprite_shader_, tex_[13], 0.6f, 1.8f, 5);
-                sub2->SetTarget(player);
-                sub2->SetRotation(3 * pi_over_two);
-                sub2->SetType(SubObj);
-                game_objects_.insert(game_objects_.begin() + 1, sub2);
-
-                SharkEnemyObject* shark1 = new SharkEnemyObject(camera_position_ + glm::vec3(1.5f, 7.0f, 0.0f), sprite_, &sprite_shader_, tex_[12], 1.0f, 1.0f, 7);
-                shark1->SetTarget(player);
-                shark1->SetScale(1.5);
-                shark1->SetType(SharkObj);
-                game_objects_.insert(game_objects_.begin() + 1, shark1);
-
-                SharkEnemyObject* shark2 = new SharkEnemyObject(camera_position_ + glm::vec3(-0.0f, 7.0f, 0.0f), sprite_, &sprite_shader_, tex_[12], 1.0f, 1.0f, 7);
-                shark2->SetTarget(player);
-                shark2->SetType(SharkObj);
-                shark2->SetScale(1.5);
-                game_objects_.insert(game_objects_.begin() + 1, shark2);
-
-                SharkEnemyObject* shark3 = new SharkEnemyObject(camera_position_ + glm::vec3(-1.5f, 7.0f, 0.0f), sprite_, &sprite_shader_, tex_[12], 1.0f, 1.0f, 7);
-                shark3->SetTarget(player);
-                shark3->SetType(SharkObj);
-                shark3->SetScale(1.5);
-                game_objects_.insert(game_objects_.begin() + 1, shark3);
-            }
-            else if (lastSecond_ == 115) {
-                MineEnemyObject* mine1 = new MineEnemyObject(camera_position_ + glm::vec3(-4.0f, 7.0f, 0.0f), sprite_, &sprite_shader_, tex_[11], 1.0f, 1.0f, 2, camera_position_ + glm::vec3(-4.0f, 7.0f, 0.0f));
-                mine1->SetVelocity(glm::vec3(0.0, 1.0, 0.0));
-                mine1->SetType(MineObj);
-                game_objects_.insert(game_objects_.begin() + 1, mine1);
-
-                MineEnemyObject* mine2 = new MineEnemyObject(camera_position_ + glm::vec3(-3.0f, 7.0f, 0.0f), sprite_, &sprite_shader_, tex_[11], 1.0f, 1.0f, 2, camera_position_ + glm::vec3(-3.0f, 7.0f, 0.0f));
-                mine2->SetVelocity(glm::vec3(0.0, 1.0, 0.0));
-                mine2->SetType(MineObj);
-                game_objects_.insert(game_objects_.begin() + 1, mine2);
-
-                MineEnemyObject* mine3 = new MineEnemyObject(camera_position_ + glm::vec3(-1.5f, 7.0f, 0.0f), sprite_, &sprite_shader_, tex_[11], 1.0f, 1.0f, 2, camera_position_ + glm::vec3(-1.5f, 7.0f, 0.0f));
-                mine3->SetVelocity(glm::vec3(0.0, 1.0, 0.0));
-                mine3->SetType(MineObj);
-                game_objects_.insert(game_objects_.begin() + 1, mine3);
-
-                MineEnemyObject* mine4 = new MineEnemyObject(camera_position_ + glm::vec3(0.0f, 7.0f, 0.0f), sprite_, &sprite_shader_, tex_[11], 1.0f, 1.0f, 2, camera_position_ + glm::vec3(0.0f, 7.0f, 0.0f));
-                mine4->SetVelocity(glm::vec3(0.0, 1.0, 0.0));
-                mine4->SetType(MineObj);
-                game_objects_.insert(game_objects_.begin() + 1, mine4);
-
-                MineEnemyObject* mine5 = new MineEnemyObject(camera_position_ + glm::vec3(1.5f, 7.0f, 0.0f), sprite_, &sprite_shader_, tex_[11], 1.0f, 1.0f, 2, camera_position_ + glm::vec3(1.5f, 7.0f, 0.0f));
-                mine5->SetVelocity(glm::vec3(0.0, 1.0, 0.0));
-                mine5->SetType(MineObj);
-                game_objects_.insert(game_objects_.begin() + 1, mine5);
-
-                MineEnemyObject* mine6 = new MineEnemyObject(camera_position_ + glm::vec3(3.0f, 7.0f, 0.0f), sprite_, &sprite_shader_, tex_[11], 1.0f, 1.0f, 2, camera_position_ + glm::vec3(3.0f, 7.0f, 0.0f));
-                mine6->SetVelocity(glm::vec3(0.0, 1.0, 0.0));
-                mine6->SetType(MineObj);
-                game_objects_.insert(game_objects_.begin() + 1, mine6);
-
-                MineEnemyObject* mine7 = new MineEnemyObject(camera_position_ + glm::vec3(4.0f, 7.0f, 0.0f), sprite_, &sprite_shader_, tex_[11], 1.0f, 1.0f, 2, camera_position_ + glm::vec3(4.0f, 7.0f, 0.0f));
-                mine7->SetVelocity(glm::vec3(0.0, 1.0, 0.0));
-                mine7->SetType(MineObj);
-                game_objects_.insert(game_objects_.begin() + 1, mine7);
-
-                SharkEnemyObject* shark1 = new SharkEnemyObject(camera_position_ + glm::vec3(1.5f, 6.0f, 0.0f), sprite_, &sprite_shader_, tex_[12], 1.0f, 1.0f, 7);
-                shark1->SetTarget(player);
-                shark1->SetScale(1.5);
-                shark1->SetType(SharkObj);
-                game_objects_.insert(game_objects_.begin() + 1, shark1);
-
-                SharkEnemyObject* shark2 = new SharkEnemyObject(camera_position_ + glm::vec3(-0.0f, 6.0f, 0.0f), sprite_, &sprite_shader_, tex_[12], 1.0f, 1.0f, 7);
-                shark2->SetTarget(player);
-                shark2->SetType(SharkObj);
-                shark2->SetScale(1.5);
-                game_objects_.insert(game_objects_.begin() + 1, shark2);
-
-                SharkEnemyObject* shark3 = new SharkEnemyObject(camera_position_ + glm::vec3(-1.5f, 6.0f, 0.0f), sprite_, &sprite_shader_, tex_[12], 1.0f, 1.0f, 7);
-                shark3->SetTarget(player);
-                shark3->SetType(SharkObj);
-                shark3->SetScale(1.5);
-                game_objects_.insert(game_objects_.begin() + 1, shark3);
-            }
-            else if (lastSecond_ == 130) {
-                SubEnemyObject* sub1 = new SubEnemyObject(camera_position_ + glm::vec3(-3.0f, 7.5f, 0.0f), sprite_, &sprite_shader_, tex_[13], 0.6f, 1.8f, 5);
-                sub1->SetTarget(player);
-                sub1->SetRotation(3 * pi_over_two);
-                sub1->SetType(SubObj);
-                game_objects_.insert(game_objects_.begin() + 1, sub1);
-
-                SubEnemyObject* sub2 = new SubEnemyObject(camera_position_ + glm::vec3(0.0f, 7.0f, 0.0f), sprite_, &sprite_shader_, tex_[13], 0.6f, 1.8f, 5);
-                sub2->SetTarget(player);
-                sub2->SetRotation(3 * pi_over_two);
-                sub2->SetType(SubObj);
-                game_objects_.insert(game_objects_.begin() + 1, sub2);
-
-                SubEnemyObject* sub3 = new SubEnemyObject(camera_position_ + glm::vec3(2.0f, 7.5f, 0.0f), sprite_, &sprite_shader_, tex_[13], 0.6f, 1.8f, 5);
-                sub3->SetTarget(player);
-                sub3->SetRotation(3 * pi_over_two);
-                sub3->SetType(SubObj);
-                game_objects_.insert(game_objects_.begin() + 1, sub3);
-
-                SubEnemyObject* sub4 = new SubEnemyObject(camera_position_ + glm::vec3(4.0f, 7.5f, 0.0f), sprite_, &sprite_shader_, tex_[13], 0.6f, 1.8f, 5);
-                sub4->SetTarget(player);
-                sub4->SetRotation(3 * pi_over_two);
-                sub4->SetType(SubObj);
-                game_objects_.insert(game_objects_.begin() + 1, sub4);
-
-                SubEnemyObject* sub5 = new SubEnemyObject(camera_position_ + glm::vec3(-1.5f, 7.5f, 0.0f), sprite_, &sprite_shader_, tex_[13], 0.6f, 1.8f, 5);
-                sub5->SetTarget(player);
-                sub5->SetRotation(3 * pi_over_two);
-                sub5->SetType(SubObj);
-                game_objects_.insert(game_objects_.begin() + 1, sub5);
-
-                SharkEnemyObject* shark1 = new SharkEnemyObject(camera_position_ + glm::vec3(1.5f, 7.0f, 0.0f), sprite_, &sprite_shader_, tex_[12], 1.0f, 1.0f, 7);
-                shark1->SetTarget(player);
-                shark1->SetScale(1.5);
-                shark1->SetType(SharkObj);
-                game_objects_.insert(game_objects_.begin() + 1, shark1);
-
-                SharkEnemyObject* shark2 = new SharkEnemyObject(camera_position_ + glm::vec3(-0.0f, 7.0f, 0.0f), sprite_, &sprite_shader_, tex_[12], 1.0f, 1.0f, 7);
-                shark2->SetTarget(player);
-                shark2->SetType(SharkObj);
-                shark2->SetScale(1.5);
-                game_objects_.insert(game_objects_.begin() + 1, shark2);
+    }
 
-            }
-            else if (lastSecond_ == 150) {
-                BossSubObject* boss = new BossSubObject(camera_position_ + glm::vec3(0.0f, 5.5f, 0.0f), sprite_, &sprite_shader_, tex_[19], 1.0f, 1.25f, 20);
-                boss->SetScale(8.0f);
-                boss->SetTarget(player);
-                //boss->SetRotation(3* pi_over_two);
-                boss->SetType(BossObj);
-                game_objects_.insert(game_objects_.begin() + 1, boss);
-
-                BossTurretObject* turret1 = new BossTurretObject(glm::vec3(-3.55f, 1.4f, -0.5f), sprite_, &sprite_shader_, tex_[16], boss, glm::vec3(-3.55f, 1.4f, -0.5f), 1.0f, 1.0f, 10);
-                turret1->SetTarget(player);
-                turret1->SetScale(3.0f);
-                turret1->SetRotation(-pi_over_two);
-                turret1->SetType(TurretObj);
-                BossTurretObject* turret2 = new BossTurretObject(glm::vec3(-1.95f, 1.4f, -0.5f), sprite_, &sprite_shader_, tex_[16], boss, glm::vec3(-3.55f, 1.4f, -0.5f), 1.0f, 1.0f, 10);
-                turret2->SetTarget(player);
-                turret2->SetScale(3.0f);
-                turret2->SetRotation(-pi_over_two);
-                turret2->SetType(TurretObj);
-                BossTurretObject* turret3 = new BossTurretObject(glm::vec3(1.95f, 1.4f, -0.5f), sprite_, &sprite_shader_, tex_[16], boss, glm::vec3(-3.55f, 1.4f, -0.5f), 1.0f, 1.0f, 10);
-                turret3->SetTarget(player);
-                turret3->SetScale(3.0f);
-                turret3->SetRotation(-pi_over_two);
-                turret3->SetType(TurretObj);
-                BossTurretObject* turret4 = new BossTurretObject(glm::vec3(3.55f, 1.4f, -0.5f), sprite_, &sprite_shader_, tex_[16], boss, glm::vec3(-3.55f, 1.4f, -0.5f), 1.0f, 1.0f, 10);
-                turret4->SetTarget(player);
-                turret4->SetScale(3.0f);
-                turret4->SetRotation(-pi_over_two);
-                turret4->SetType(TurretObj);
-
-                game_objects_.insert(game_objects_.begin() + 1, turret1);
-                game_objects_.insert(game_objects_.begin() + 1, turret2);
-                game_objects_.insert(game_objects_.begin() + 1, turret3);
-                game_objects_.insert(game_objects_.begin() + 1, turret4);
-            }
+    // Spawn the wave events that are due
+    // Wave times are read off the HUD timer, which rounds the game time to
+    // the nearest second, so events are due half a second early
+    {
+        ProfileScope scope(profiler_, ProfileWaves);
+        const WaveEvent *event;
+        while ((event = waves_.Next(current_time_ + 0.5)) != nullptr) {
+            SpawnWaveEvent(*event);
         }
     }
 
-    
-
-    
     // Update all game objects
-    for (int i = 0; i < game_objects_.size(); i++) {
-        // Get the current game object
+    // Each type of object is updated by its own system, over the objects
+    // of that type only; objects ahead of the activation band sleep
+    // Objects spawned during the update are added at the end and are
+    // first updated in the next step
+    GroupByType();
+    int num_moving = motion_.Size();
+
+    // Attached objects move with their parent, and go away with it
+    for (int i = 0; i < game_objects_.Size(); i++) {
         GameObject* current_game_object = game_objects_[i];
-        
-
-        // Update the current game object
-        // Uses dynamic casts to update specific objects if necessary
-        if (current_game_object->GetType() == PlayerObj) {
-            PlayerGameObject* player = dynamic_cast<PlayerGameObject*>(current_game_object);
-            player->Update(delta_time, camera_position_);
-            if (!player->GetAlive() && player->GetDeath()->Finished()) player_dead_ = true;
-        }
-        else if (current_game_object->GetType() == TimerObj) {
-            TextGameObject* timer = dynamic_cast<TextGameObject*>(current_game_object);
-            timer->Update(delta_time);
-            std::string time = std::to_string(lastSecond_);
-            timer->SetText("Time: " + time);
-        }
-        else if (current_game_object->GetType() == HealthObj) {
-            TextGameObject* health = dynamic_cast<TextGameObject*>(current_game_object);
-            health->Update(delta_time);
-            float percent = player->GetHealth();
-            percent /= 10;
-            std::string healthVal = std::to_string((int)(percent * 100));
-            health->SetText("|Hull Integrity: " + healthVal + "%");
+        if (!current_game_object->GetParent().IsNull()) {
+            GameObject* parent = GetGameObject(current_game_object->GetParent());
+            if (parent != nullptr) current_game_object->FollowParent(*parent);
+            else current_game_object->SetAlive(false);
         }
-        else if (current_game_object->GetType() == ScoreObj) {
-            TextGameObject* score = dynamic_cast<TextGameObject*>(current_game_object);
-            score->Update(delta_time);
-            std::string scoreVal = std::to_string(score_);
-            score->SetText("|Score: " + scoreVal);
-        }
-        // Updates sub enemy, also implements combat behaviour
-        else if (current_game_object->GetType() == SubObj) {
-            SubEnemyObject* sub = dynamic_cast<SubEnemyObject*>(current_game_object);
-            sub->Update(delta_time, camera_position_);
-            if (sub->GetAlive()) {
-                if (current_time_ > sub->GetNextShot()) {
-                    Bullet* torpedo1 = new Bullet(sub->GetPosition(), sprite_, &sprite_shader_, tex_[14], 1.0f, 1.0f, 1);
-                    torpedo1->SetRotation(sub->GetRotation() + glm::pi<float>() / 4.0);
-                    torpedo1->SetVelocity(3.0f * sub->GetBottomRight());
-                    torpedo1->SetScale(0.75f);
-                    torpedo1->SetOrigin(sub->GetPosition() - glm::vec3(0.0f, 0.55f, 0.0f));
-                    torpedo1->SetType(SubTorpedoObj);
-                    game_objects_.insert(game_objects_.begin() + 1, torpedo1);
-
-                    GameObject* particles1 = new ParticleSystem(glm::vec3(-0.45f, 0.0f, 0.0f), particles_, &particle_shader_, tex_[4], torpedo1, 1.0f, 1.0f, 1);
-                    particles1->SetScale(0.1);
-                    particles1->SetRotation(sub->GetRotation());
-                    torpedo1->SetParticles(particles1);
-                    game_objects_.push_back(particles1);
-
-                    Bullet* torpedo2 = new Bullet(sub->GetPosition(), sprite_, &sprite_shader_, tex_[14], 1.0f, 1.0f, 1);
-                    torpedo2->SetRotation(sub->GetRotation() - glm::pi<float>() / 4.0);
-                    torpedo2->SetVelocity(3.0f * sub->GetBottomLeft());
-                    torpedo2->SetScale(0.75f);
-                    torpedo2->SetOrigin(sub->GetPosition() - glm::vec3(0.0f, 0.55f, 0.0f));
-                    torpedo2->SetType(SubTorpedoObj);
-                    game_objects_.insert(game_objects_.begin() + 1, torpedo2);
-                    sub->SetNextShot(current_time_ + 3.0);
-
-                    GameObject* particles2 = new ParticleSystem(glm::vec3(-0.45f, 0.0f, 0.0f), particles_, &particle_shader_, tex_[4], torpedo2, 1.0f, 1.0f, 1);
-                    particles2->SetScale(0.1);
-                    particles2->SetRotation(sub->GetRotation());
-                    torpedo2->SetParticles(particles2);
-                    game_objects_.push_back(particles2);
-                }
-            }
+    }
+
+    for (int type = 0; type < NumObjectTypes; type++) {
+        ProfileScope scope(profiler_, update_zones_[type]);
+        (this->*update_systems_[type])(archetypes_[type], delta_time);
+    }
+
+    // Move everything in the motion store, then copy the new positions
+    // back to the objects. Objects spawned by the systems above are not
+    // moved until the next step, like the rest of their update
+    {
+        ProfileScope scope(profiler_, ProfileMotion);
+        motion_.Integrate((float)delta_time, num_moving);
+        for (int i = 0; i < num_moving; i++) {
+            motion_.GetOwner(i)->SetPosition(motion_.GetPosition(i));
         }
-        // Updates boss, implements combat behaviour
-        else if (current_game_object->GetType() == BossObj) {
-            BossSubObject* boss = dynamic_cast<BossSubObject*>(current_game_object);
-            boss->Update(delta_time, camera_position_);
-            if (boss->GetAlive()) {
-                if (current_time_ > boss->GetNextShot()) {
-                    Bullet* torpedo1 = new Bullet(boss->GetPosition(), sprite_, &sprite_shader_, tex_[14], 1.0f, 1.0f, 1);
-                    torpedo1->SetRotation(boss->GetRotation() - (3 * glm::pi<float>()) / 4.0);
-                    torpedo1->SetVelocity(3.0f * -boss->GetBottomRight());
-                    torpedo1->SetScale(0.75f);
-                    torpedo1->SetOrigin(boss->GetPosition() + glm::vec3(0.0f, 0.8f, 0.0f));
-                    torpedo1->SetType(SubTorpedoObj);
-                    game_objects_.insert(game_objects_.begin() + 1, torpedo1);
-
-                    GameObject* particles1 = new ParticleSystem(glm::vec3(-0.45f, 0.0f, 0.0f), particles_, &particle_shader_, tex_[4], torpedo1, 1.0f, 1.0f, 1);
-                    particles1->SetScale(0.1);
-                    particles1->SetRotation(torpedo1->GetRotation() + glm::pi<float>() / 4.0);
-                    torpedo1->SetParticles(particles1);
-                    game_objects_.push_back(particles1);
-
-                    Bullet* torpedo2 = new Bullet(boss->GetPosition(), sprite_, &sprite_shader_, tex_[14], 1.0f, 1.0f, 1);
-                    torpedo2->SetRotation(boss->GetRotation() - glm::pi<float>() / 4.0);
-                    torpedo2->SetVelocity(3.0f * boss->GetBottomLeft());
-                    torpedo2->SetScale(0.75f);
-                    torpedo2->SetOrigin(boss->GetPosition() + glm::vec3(0.0f, 0.8f, 0.0f));
-                    torpedo2->SetType(SubTorpedoObj);
-                    game_objects_.insert(game_objects_.begin() + 1, torpedo2);
-
-                    GameObject* particles2 = new ParticleSystem(glm::vec3(-0.45f, 0.0f, 0.0f), particles_, &particle_shader_, tex_[4], torpedo2, 1.0f, 1.0f, 1);
-                    particles2->SetScale(0.1);
-                    particles2->SetRotation(torpedo2->GetRotation() - glm::pi<float>() / 4.0);
-                    torpedo2->SetParticles(particles2);
-                    game_objects_.push_back(particles2);
-
-                    Bullet* torpedo3 = new Bullet(boss->GetPosition(), sprite_, &sprite_shader_, tex_[14], 1.0f, 1.0f, 1);
-                    torpedo3->SetRotation(boss->GetRotation() - glm::pi<float>() / 2.0);
-                    torpedo3->SetVelocity(3.0f * boss->GetRight());
-                    torpedo3->SetScale(0.75f);
-                    torpedo3->SetOrigin(boss->GetPosition() + glm::vec3(0.0f, 0.8f, 0.0f));
-                    torpedo3->SetType(SubTorpedoObj);
-                    game_objects_.insert(game_objects_.begin() + 1, torpedo3);
-                    if (turret_killcount_ < 2) boss->SetNextShot(current_time_ + 3.0);
-                    else if (turret_killcount_ < 3) boss->SetNextShot(current_time_ + 2.5);
-                    else if (turret_killcount_ < 4) boss->SetNextShot(current_time_ + 2.0);
-                    else boss->SetNextShot(current_time_ + 1.0);
-
-                    GameObject* particles3 = new ParticleSystem(glm::vec3(-0.45f, 0.0f, 0.0f), particles_, &particle_shader_, tex_[4], torpedo3, 1.0f, 1.0f, 1);
-                    particles3->SetScale(0.1);
-                    particles3->SetRotation(torpedo3->GetRotation());
-                    torpedo3->SetParticles(particles3);
-                    game_objects_.push_back(particles3);
-                }
+    }
+
+    // Refresh the HUD
+    // The text is formatted in place to keep string allocations out of the step
+    char hud_text[TEXT_LENGTH + 1];
+    TextGameObject* timer = static_cast<TextGameObject*>(GetGameObject(timer_text_handle_));
+    snprintf(hud_text, sizeof(hud_text), "Time: %d", lastSecond_);
+    timer->SetText(hud_text);
+
+    TextGameObject* health = static_cast<TextGameObject*>(GetGameObject(health_text_handle_));
+    float percent = player->GetHealth();
+    percent /= 10;
+    snprintf(hud_text, sizeof(hud_text), "|Hull Integrity: %d%%", (int)(percent * 100));
+    health->SetText(hud_text);
+
+    TextGameObject* score = static_cast<TextGameObject*>(GetGameObject(score_text_handle_));
+    snprintf(hud_text, sizeof(hud_text), "|Score: %d", score_);
+    score->SetText(hud_text);
+
+    // Broad phase: put everything projectiles and the player can hit into a
+    // uniform grid, so each collision test only looks at nearby objects
+    {
+        ProfileScope scope(profiler_, ProfileBroadPhase);
+        collision_grid_.Clear();
+        for (int i = 0; i < game_objects_.Size(); i++) {
+            GameObject* other_game_object = game_objects_[i];
+            if (!other_game_object->GetAwake()) continue;
+            ObjectType type = other_game_object->GetType();
+            if (type == EnemyObj || type == MineObj || type == SharkObj || type == SubObj) {
+                collision_grid_.Insert(i, other_game_object->GetPosition(), other_game_object->GetScale() * 0.45f);
             }
-            if (!boss->GetAlive() && boss->GetDeath()->Finished()) boss_dead_ = true;
-            if (boss_vuln_ == true) boss->SetTexture(tex_[15]);
-        }
-        else current_game_object->Update(delta_time);
-
-        // Shark firing
-        if (current_game_object->GetType() == SharkObj) {
-            SharkEnemyObject* shark = dynamic_cast<SharkEnemyObject*>(current_game_object);
-            if (shark->GetAlive()) {
-                if (current_time_ > shark->GetNextShot()) {
-                    Bullet* bullet = new Bullet(shark->GetPosition(), sprite_, &sprite_shader_, tex_[9], 1.0f, 1.0f, 1);
-                    bullet->SetRotation(shark->GetRotation() - glm::pi<float>() / 2.0);
-                    bullet->SetVelocity(4.0f * shark->GetBearing());
-                    bullet->SetOrigin(shark->GetPosition());
-                    bullet->SetType(SharkBulletObj);
-                    game_objects_.insert(game_objects_.begin() + 1, bullet);
-                    shark->SetNextShot(current_time_ + 1.5);
-                }
+            else if (type == TurretObj) {
+                BossTurretObject* turret = static_cast<BossTurretObject*>(other_game_object);
+                collision_grid_.Insert(i, turret->GetFakePosition(), turret->GetScale() * 0.2f);
             }
-        } // Turret firing
-        else if (current_game_object->GetType() == TurretObj) {
-            BossTurretObject* turret = dynamic_cast<BossTurretObject*>(current_game_object);
-            if (turret->GetAlive()) {
-                if (current_time_ > turret->GetNextShot()) {
-                    Bullet* bullet = new Bullet(turret->GetFakePosition(), sprite_, &sprite_shader_, tex_[9], 1.0f, 1.0f, 1);
-                    bullet->SetRotation(turret->GetRotation());
-                    bullet->SetVelocity(5.0f * -turret->GetRight());
-                    bullet->SetOrigin(turret->GetFakePosition());
-                    bullet->SetType(SharkBulletObj);
-                    game_objects_.insert(game_objects_.begin() + 1, bullet);
-                    turret->SetNextShot(current_time_ + 2.0);
-                }
+            else if (type == BossObj || type == ItemObj) {
+                collision_grid_.Insert(i, other_game_object->GetPosition(), other_game_object->GetScale() * 0.2f);
             }
-
         }
+        collision_grid_.Build();
+    }
 
-        // Check for collision with other game objects
-        if (current_game_object->GetType() == BulletObj){
-            // If the object is a bullet, use its special collision function
-            // Cast the object into a bullet
-            Bullet *bullet = dynamic_cast<Bullet*>(current_game_object);
-            // Check for ray-circle collision with general enemy game objects with player javelins
-            for (int j = 0; j < (game_objects_.size() - 1); j++) {
-                GameObject* other_game_object = game_objects_[j];
-                if (other_game_object->GetType() == EnemyObj || other_game_object->GetType() == MineObj || 
-                    other_game_object->GetType() == SharkObj || other_game_object->GetType() == SubObj){
-                    if (bullet->CheckCollision(other_game_object->GetPosition(), other_game_object->GetScale()*0.45)){
-                        // Don't remove objects now
-                        // Add them to a list to remove them later (code down below)
-                        //to_erase.push_back(othwer_game_object);
-                        if (other_game_object->TakeDamage(1 * damage_factor_) == true) {
-                            killcount_++;
-                            other_game_object->GetDeath()->Start(0.15);
-                            ParticleSystem* explosion = new ParticleSystem(glm::vec3(0.0f, 0.0f, -2.0f), explosion_particles_, &particle_shader_, tex_[4], other_game_object, 1.0f, 1.0f, 1);
-                            explosion->SetScale(0.25f);
-                            explosion->SetType(PSystemExplosionObj);
-                            other_game_object->SetParticles(explosion);
-                            game_objects_.push_back(explosion);
-
-                            if (killcount_ % 15 == 0) {
-                                ItemGameObject* powerUp = new ItemGameObject(other_game_object->GetPosition(), sprite_, &sprite_shader_, tex_[21], 1.0f, 1.0f, 1);
-                                powerUp->SetItemType(InvinciblePower);
-                                powerUp->SetScale(1.5);
-                                game_objects_.insert(game_objects_.begin() + 1, powerUp);
-                            }
-                        }
-                        bullet->SetAlive(false);
-                        // If an intersection happened and objects will be removed,
-                        // don't check for more intersections
-                        break;
-                    }
-                }
-                // Javelin collision with turrets
-                else if (other_game_object->GetType() == TurretObj) {
-                    BossTurretObject* turret = dynamic_cast<BossTurretObject*>(other_game_object);
-                    if (turret->GetAlive()) {
-                        if (bullet->CheckCollision(turret->GetFakePosition(), turret->GetScale() * 0.1)) {
-                            // Don't remove objects now
-                            // Add them to a list to remove them later (code down below)
-                            //to_erase.push_back(other_game_object);
-                            if (turret->TakeDamage(1 * damage_factor_) == true) {
-                                killcount_++;
-                                turret_killcount_++;
-                                turret->GetDeath()->Start(0.25);
-                                if (turret_killcount_ >= 4) {
-                                    boss_vuln_ = true;
-                                }
-                            }
-                            //to_erase.push_back(bullet);
-                            bullet->SetAlive(false);
-                            // If an intersection happened and objects will be removed,
-                            // don't check for more intersections
-                            break;
-                        }
-                    }
-                    
-                }
-                // Javelin collision with boss
-                else if (other_game_object->GetType() == BossObj && turret_killcount_ >= 4) {
-                    BossSubObject* boss = dynamic_cast<BossSubObject*>(other_game_object);
-
-                    if (bullet->CheckCollision(boss->GetPosition(), boss->GetScale() * 0.1)) {
-                        
-                        if (boss->TakeDamage(1 * damage_factor_) == true) {
-                            boss->GetDeath()->Start(3.0);
-                            ParticleSystem* explosion = new ParticleSystem(glm::vec3(0.0f, 0.0f, -2.0f), explosion_particles_, &particle_shader_, tex_[4], boss, 1.0f, 1.0f, 1);
-                            explosion->SetScale(0.8f);
-                            explosion->SetType(PSystemExplosionObj);
-                            boss->SetParticles(explosion);
-                            game_objects_.push_back(explosion);
-                            mission_complete_ = true;
-
-                            TextGameObject* text6 = new TextGameObject(camera_position_ + glm::vec3(0.0f, 2.75f, -1.0f), sprite_, &text_shader_, tex_[17], 0.5f, 10.7f, 1);
-                            //text6->SetScale(0.1f);
-                            text6->SetType(ExplainObj);
-                            text6->SetVelocity(glm::vec3(0.0f, 1.0f, 0.0f));
-                            text6->SetText("MISSION ACCOMPLISHED");
-                            game_objects_.push_back(text6);
-                            text6->SetAlive(false);
-                            text6->GetDeath()->Start(3);
-                        }
-                        //to_erase.push_back(bullet);
-                        bullet->SetAlive(false);
-                        // If an intersection happened and objects will be removed,
-                        // don't check for more intersections
+    // Check for collisions
+    // Detection only reads the game and publishes what it finds as events;
+    // they are applied after, and what they spawn added at the end, so the
+    // grid indices stay valid
+    int num_objects = game_objects_.Size();
+
+    // The player doesn't move while collisions are checked, so all the
+    // enemy shots are tested against it at once, in the order they are
+    // met below
+    {
+        ProfileScope scope(profiler_, ProfileEnemyShots);
+        shark_shots_.Clear();
+        sub_torpedoes_.Clear();
+        for (int i = 0; i < num_objects; i++) {
+            ObjectType type = game_objects_[i]->GetType();
+            if (type == SharkBulletObj) static_cast<Bullet*>(game_objects_[i])->AddSweep(shark_shots_);
+            else if (type == SubTorpedoObj) static_cast<Bullet*>(game_objects_[i])->AddSweep(sub_torpedoes_);
+        }
+        glm::vec2 player_center(player->GetPosition().x, player->GetPosition().y);
+        shark_shots_.Sweep(player_center, player->GetScale() * 0.6);
+        sub_torpedoes_.Sweep(player_center, player->GetScale() * 0.7);
+    }
+    int shark_shot = 0;
+    int sub_torpedo = 0;
+
+    // Sweeping the player's projectiles only reads the game, so threads
+    // share them out, each recording the hits it finds in its own buffer.
+    // The buffers are merged in the order of the projectiles, and the hits
+    // applied below in that order, so the outcome is the same on any
+    // number of threads
+    {
+        ProfileScope scope(profiler_, ProfileSweeps);
+        projectiles_.clear();
+        for (int i = 0; i < num_objects; i++) {
+            ObjectType type = game_objects_[i]->GetType();
+            if (type == BulletObj || type == TorpedoObj) projectiles_.push_back(i);
+        }
+        for (int thread = 0; thread < sweep_buffers_.size(); thread++) {
+            sweep_buffers_[thread].hits.clear();
+        }
+        jobs_.ParallelFor((int)projectiles_.size(), sweep_grain_g, [this](int begin, int end, int thread) {
+            SweepProjectiles(begin, end, thread);
+        });
+        sweep_hits_.clear();
+        for (int thread = 0; thread < sweep_buffers_.size(); thread++) {
+            std::vector<SweepHit> &hits = sweep_buffers_[thread].hits;
+            sweep_hits_.insert(sweep_hits_.end(), hits.begin(), hits.end());
+        }
+        std::sort(sweep_hits_.begin(), sweep_hits_.end());
+    }
+    int sweep_hit = 0;
 
-                    }
+    // Find what collided, publishing it on the event bus
+    events_.Clear();
+    for (int i = 0; i < num_objects; i++) {
+        GameObject* current_game_object = game_objects_[i];
+        ObjectType type = current_game_object->GetType();
+
+        // Javelins and torpedoes damage the first enemy or live turret
+        // their sweep hits, and the boss if it is on the way
+        if (type == BulletObj || type == TorpedoObj) {
+            ProfileScope scope(profiler_, (type == BulletObj) ? ProfileJavelins : ProfileTorpedoes);
+            // Base damage, before weapon upgrades
+            int damage = (type == BulletObj) ? 1 : 3;
+            int first_hit = sweep_hit;
+            while (sweep_hit < sweep_hits_.size() && sweep_hits_[sweep_hit].projectile == i) sweep_hit++;
+            for (int j = first_hit; j < sweep_hit; j++) {
+                GameObject* other_game_object = game_objects_[sweep_hits_[j].target];
+                ObjectType other_type = other_game_object->GetType();
+                DamageEvent hit = { other_game_object->GetHandle(), current_game_object->GetHandle(), damage };
+                if (other_type == EnemyObj || other_type == MineObj || other_type == SharkObj || other_type == SubObj) {
+                    events_.Publish(hit);
+                    // Don't check for more intersections
+                    break;
                 }
-            }
-        }
-        else if (current_game_object->GetType() == TorpedoObj) {
-            Bullet* bullet = dynamic_cast<Bullet*>(current_game_object);
-            // Check for ray-circle collision with enemy game objects
-            for (int j = 0; j < (game_objects_.size() - 1); j++) {
-                GameObject* other_game_object = game_objects_[j];
-                // Torpedo collision with general enemies
-                if (other_game_object->GetType() == EnemyObj || other_game_object->GetType() == MineObj ||
-                    other_game_object->GetType() == SharkObj || other_game_object->GetType() == SubObj) {
-                    if (bullet->CheckCollision(other_game_object->GetPosition(), other_game_object->GetScale() * 0.45)) {
-                        // Don't remove objects now
-                        // Add them to a list to remove them later (code down below)
-                        //to_erase.push_back(other_game_object);
-                        if (other_game_object->TakeDamage(3 * damage_factor_) == true) {
-                            killcount_++;
-                            other_game_object->GetDeath()->Start(0.15);
-                            ParticleSystem* explosion = new ParticleSystem(glm::vec3(0.0f, 0.0f, -2.0f), explosion_particles_, &particle_shader_, tex_[4], other_game_object, 1.0f, 1.0f, 1);
-                            explosion->SetScale(0.25f);
-                            explosion->SetType(PSystemExplosionObj);
-                            other_game_object->SetParticles(explosion);
-                            game_objects_.push_back(explosion);
-
-                            if (killcount_ % 15 == 0) {
-                                ItemGameObject* powerUp = new ItemGameObject(camera_position_ + glm::vec3(0.0f, 2.0f, 0.0f), sprite_, &sprite_shader_, tex_[21], 1.0f, 1.0f, 1); 
-                                powerUp->SetItemType(InvinciblePower);
-                                powerUp->SetScale(1.5);
-                                game_objects_.insert(game_objects_.begin() + 1, powerUp); 
-                            }
-                        }
-                        //to_erase.push_back(bullet);
-                        bullet->SetAlive(false);
-                        // If an intersection happened and objects will be removed,
-                        // don't check for more intersections
+                else if (other_type == TurretObj) {
+                    if (other_game_object->GetAlive()) {
+                        events_.Publish(hit);
                         break;
                     }
                 }
-                // Torpedo collision with turrets
-                else if (other_game_object->GetType() == TurretObj) {
-                    BossTurretObject* turret = dynamic_cast<BossTurretObject*>(other_game_object);
-                    if (turret->GetAlive()) {
-                        if (bullet->CheckCollision(turret->GetFakePosition(), turret->GetScale() * 0.2)) {
-                            // Don't remove objects now
-                            // Add them to a list to remove them later (code down below)
-                            //to_erase.push_back(other_game_object);
-                            if (turret->TakeDamage(3 * damage_factor_) == true) {
-                                killcount_++;
-                                turret_killcount_++;
-                                turret->GetDeath()->Start(0.25);
-                                if (turret_killcount_ >= 4) {
-                                    boss_vuln_ = true;
-                                }
-                            }
-                            //to_erase.push_back(bullet);
-                            bullet->SetAlive(false);
-                            // If an intersection happened and objects will be removed,
-                            // don't check for more intersections
-                            break;
-                        }
-                    }
-                    
-                }
-                // Torpedo collision with boss
-                else if (other_game_object->GetType() == BossObj && turret_killcount_ >= 4) {
-                    BossSubObject* boss = dynamic_cast<BossSubObject*>(other_game_object);
-
-                    if (bullet->CheckCollision(boss->GetPosition(), boss->GetScale() * 0.2)) {
-                        // Don't remove objects now
-                        // Add them to a list to remove them later (code down below)
-                        if (boss->TakeDamage(3 * damage_factor_) == true) {
-                            //boss_dead_ = true;
-                            boss->GetDeath()->Start(5.0);
-                            ParticleSystem* explosion = new ParticleSystem(glm::vec3(0.0f, 0.0f, -2.0f), explosion_particles_, &particle_shader_, tex_[4], boss, 1.0f, 1.0f, 1);
-                            explosion->SetScale(0.8f);
-                            explosion->SetType(PSystemExplosionObj);
-                            boss->SetParticles(explosion);
-                            game_objects_.push_back(explosion);
-                            mission_complete_ = true;
-
-                            TextGameObject* text6 = new TextGameObject(camera_position_ + glm::vec3(0.0f, 2.75f, -1.0f), sprite_, &text_shader_, tex_[17], 0.5f, 10.7f, 1);
-                            //text6->SetScale(0.1f);
-                            text6->SetType(ExplainObj);
-                            text6->SetVelocity(glm::vec3(0.0f, 1.0f, 0.0f));
-                            text6->SetText("MISSION ACCOMPLISHED");
-                            game_objects_.push_back(text6);
-                            text6->SetAlive(false);
-                            text6->GetDeath()->Start(3);
-                        }
-                        //to_erase.push_back(bullet);
-                        bullet->SetAlive(false);
-                        // If an intersection happened and objects will be removed,
-                        // don't check for more intersections
-
-                    }
+                else if (other_type == BossObj) {
+                    // The boss only takes it once its turrets are destroyed,
+                    // and doesn't stop the projectile
+                    events_.Publish(hit);
                 }
             }
         }
-        // Enemy bullet collision with player
-        else if (current_game_object->GetType() == SharkBulletObj) {
-            Bullet* bullet = dynamic_cast<Bullet*>(current_game_object);
- 
-            if (bullet->CheckCollision(player->GetPosition(), player->GetScale() * 0.6)) {
-                // Don't remove objects now
-                // Add them to a list to remove them later (code down below)
-                if (!player->GetInvincible() && mission_complete_ != true) {
-                    if (player->TakeDamage(1) == true) {
-
-                        player->GetDeath()->Start(1.0);
-                        TextGameObject* text6 = new TextGameObject(camera_position_ + glm::vec3(0.0f, 2.75f, -1.0f), sprite_, &text_shader_, tex_[17], 0.5f, 10.7f, 1);
-                        //text6->SetScale(0.1f);
-                        text6->SetType(ExplainObj);
-                        text6->SetVelocity(glm::vec3(0.0f, 1.0f, 0.0f));
-                        text6->SetText("M I S S I O N  F A I L E D");
-                        game_objects_.push_back(text6);
-                        text6->SetAlive(false);
-                        text6->GetDeath()->Start(1);
-                    }
-                }
-                //to_erase.push_back(bullet);
-                bullet->SetAlive(false);
-               // If an intersection happened and objects will be removed,
-               // don't check for more intersections
-                
+        // Enemy bullet and torpedo collision with player
+        else if (type == SharkBulletObj) {
+            ProfileScope scope(profiler_, ProfileEnemyShots);
+            if (shark_shots_.GetHit(shark_shot++)) {
+                DamageEvent hit = { player_handle_, current_game_object->GetHandle(), 1 };
+                events_.Publish(hit);
             }
-
         }
-        // Enemy torpedo collision with player
-        else if (current_game_object->GetType() == SubTorpedoObj) {
-           Bullet* bullet = dynamic_cast<Bullet*>(current_game_object);
-
-           if (bullet->CheckCollision(player->GetPosition(), player->GetScale() * 0.7)) {
-               // Don't remove objects now
-               // Add them to a list to remove them later (code down below)
-               if (!player->GetInvincible() && mission_complete_ != true) {
-                   if (player->TakeDamage(3) == true) {
-
-                       player->GetDeath()->Start(1.0);
-                       TextGameObject* text6 = new TextGameObject(camera_position_ + glm::vec3(0.0f, 2.75f, -1.0f), sprite_, &text_shader_, tex_[17], 0.5f, 10.7f, 1);
-                       //text6->SetScale(0.1f);
-                       text6->SetType(ExplainObj);
-                       text6->SetVelocity(glm::vec3(0.0f, 1.0f, 0.0f));
-                       text6->SetText("M I S S I O N  F A I L E D");
-                       game_objects_.push_back(text6);
-                       text6->SetAlive(false);
-                       text6->GetDeath()->Start(1);
-                   }
-               }
-               
-               //to_erase.push_back(bullet);
-               bullet->SetAlive(false);
-               // If an intersection happened and objects will be removed,
-               // don't check for more intersections
-
-           }
+        else if (type == SubTorpedoObj) {
+            ProfileScope scope(profiler_, ProfileEnemyShots);
+            if (sub_torpedoes_.GetHit(sub_torpedo++)) {
+                DamageEvent hit = { player_handle_, current_game_object->GetHandle(), 3 };
+                events_.Publish(hit);
+            }
         }
-        else {
-            // Note the loop bounds: we avoid testing the last object since
-            // it's the background covering the whole game world
-            for (int j = i + 1; j < (game_objects_.size()-1); j++) {
-                GameObject* other_game_object = game_objects_[j];
+        // Player collision with mines, enemies and items
+        else if (type == PlayerObj) {
+            ProfileScope scope(profiler_, ProfilePlayerHits);
+            collision_grid_.QueryCircle(current_game_object->GetPosition(), 0.9f, candidates_);
+            for (int j = 0; j < candidates_.size(); j++) {
+                GameObject* other_game_object = game_objects_[candidates_[j]];
 
                 // Compute distance between object i and object j
                 float distance = glm::length(current_game_object->GetPosition() - other_game_object->GetPosition());
                 // If distance is below a threshold, we have a collision
-                if (distance < 0.9f) {
-                    if (other_game_object->GetAlive()) {
-                        if (other_game_object->GetType() == MineObj && current_game_object->GetType() == PlayerObj) {
-                            if (!player->GetInvincible()) {
-                                if (current_game_object->TakeDamage(5) == true) {
-
-                                    current_game_object->GetDeath()->Start(1.0);
-                                    TextGameObject* text6 = new TextGameObject(camera_position_ + glm::vec3(0.0f, 2.75f, -1.0f), sprite_, &text_shader_, tex_[17], 0.5f, 10.7f, 1);
-                                    //text6->SetScale(0.1f);
-                                    text6->SetType(ExplainObj);
-                                    text6->SetVelocity(glm::vec3(0.0f, 1.0f, 0.0f));
-                                    text6->SetText("M I S S I O N  F A I L E D");
-                                    game_objects_.push_back(text6);
-                                    text6->SetAlive(false);
-                                    text6->GetDeath()->Start(1);
-
-                                }
-                            }
-                            //to_erase.push_back(other_game_object);
-                            other_game_object->SetAlive(false);
-                            killcount_++;
-                            other_game_object->GetDeath()->Start(0.15);
-                            ParticleSystem* explosion = new ParticleSystem(glm::vec3(0.0f, 1.0f, -2.0f), explosion_particles_, &particle_shader_, tex_[4], other_game_object, 1.0f, 1.0f, 1);
-                            explosion->SetScale(0.25f);
-                            explosion->SetType(PSystemExplosionObj);
-                            other_game_object->SetParticles(explosion);
-                            game_objects_.push_back(explosion);
-
-                        }
-                        else if ((other_game_object->GetType() == SharkObj || other_game_object->GetType() == SubObj) && current_game_object->GetType() == PlayerObj) {
-                            if (!player->GetInvincible()) {
-                                if (current_game_object->TakeDamage(2) == true) {
-
-                                    current_game_object->GetDeath()->Start(1.0);
-                                    TextGameObject* text6 = new TextGameObject(camera_position_ + glm::vec3(0.0f, 2.75f, -1.0f), sprite_, &text_shader_, tex_[17], 0.5f, 10.7f, 1);
-                                    //text6->SetScale(0.1f);
-                                    text6->SetType(ExplainObj);
-                                    text6->SetVelocity(glm::vec3(0.0f, 1.0f, 0.0f));
-                                    text6->SetText("M I S S I O N  F A I L E D");
-                                    game_objects_.push_back(text6);
-                                    text6->SetAlive(false);
-                                    text6->GetDeath()->Start(1);
-                                }
-                            }
-                            //to_erase.push_back(other_game_object);
-                            other_game_object->SetAlive(false);
-                            killcount_++;
-                            ParticleSystem* explosion = new ParticleSystem(glm::vec3(0.0f, 1.0f, -2.0f), explosion_particles_, &particle_shader_, tex_[4], other_game_object, 1.0f, 1.0f, 1);
-                            explosion->SetScale(0.25f);
-                            explosion->SetType(PSystemExplosionObj);
-                            other_game_object->SetParticles(explosion);
-                            game_objects_.push_back(explosion);
-
-                        }
-                        else if (other_game_object->GetType() == ItemObj) {
-                            ItemGameObject* item = dynamic_cast<ItemGameObject*>(other_game_object);
-                            if (item->GetItemType() == RepairKit) {
-                                score_ += 250;
-                                player->RepairHealth(player->GetMaxHealth() / 2);
-                                other_game_object->SetAlive(false);
-                            }
-                            else if (item->GetItemType() == DamageUpgrade) {
-                                score_ += 250;
-                                damage_factor_++;
-                                other_game_object->SetAlive(false);
-                            }
-                            else if (item->GetItemType() == InvinciblePower) {
-                                score_ += 500;
-                                player->PowerUp();
-                                player->SetTexture(tex_[18]);
-                                other_game_object->SetAlive(false);
-                            }
-                        }
+                if (distance < 0.9f && other_game_object->GetAlive()) {
+                    ObjectType other_type = other_game_object->GetType();
+                    // Running into an enemy hurts the player and destroys the enemy
+                    if (other_type == MineObj || other_type == SharkObj || other_type == SubObj) {
+                        DamageEvent hit = { current_game_object->GetHandle(), other_game_object->GetHandle(), (other_type == MineObj) ? 5 : 2 };
+                        KillEvent kill = { other_game_object->GetHandle(), current_game_object->GetHandle() };
+                        events_.Publish(hit);
+                        events_.Publish(kill);
+                    }
+                    else if (other_type == ItemObj) {
+                        ItemGameObject* item = static_cast<ItemGameObject*>(other_game_object);
+                        ScoreEvent pickup = { item->GetHandle(), 0 };
+                        if (item->GetItemType() == RepairKit || item->GetItemType() == DamageUpgrade) pickup.points = 250;
+                        else if (item->GetItemType() == InvinciblePower) pickup.points = 500;
+                        if (pickup.points > 0) events_.Publish(pickup);
                     }
-                    
                 }
             }
         }
-        if (current_game_object->GetType() == SharkObj && current_game_object->GetPosition().y < camera_position_.y - 6.0f) {
-            current_game_object->SetAlive(false);
+    }
+
+    // Apply the events in the order they were found, so each one sees the
+    // game as the ones before left it, then add what they spawned
+    {
+        ProfileScope scope(profiler_, ProfileEvents);
+        for (int e = 0; e < events_.GetNumEvents(); e++) {
+            switch (events_.GetType(e)) {
+                case DamageEventType:
+                    ApplyDamage(events_.GetDamage(e));
+                    break;
+                case KillEventType:
+                    ApplyKill(events_.GetKill(e));
+                    break;
+                case ScoreEventType:
+                    ApplyScore(events_.GetScore(e));
+                    break;
+            }
         }
-        if (!current_game_object->GetAlive() && current_game_object->GetDeath()->Finished()) {
-            to_erase.push_back(current_game_object);
+        for (int s = 0; s < events_.GetNumSpawns(); s++) {
+            Spawn(events_.GetSpawn(s));
         }
     }
 
     if (!player->GetInvincible()) player->SetTexture(tex_[6]);
 
-    // Remove game objects save in the to_erase vector
-    for (int i = 0; i < to_erase.size(); i++){
-        for (int j = 0; j < game_objects_.size(); j++){
-            if (game_objects_[j] == to_erase[i]){
-                delete game_objects_[j];
-                game_objects_.erase(game_objects_.begin() + j);
-                //std::cout << "SOMETHING WAS DELETED" << std::endl;
-                break;
+    // Find the objects to remove
+    {
+        ProfileScope scope(profiler_, ProfileRemoval);
+        for (int i = 0; i < game_objects_.Size(); i++) {
+            GameObject* current_game_object = game_objects_[i];
+            ObjectType type = current_game_object->GetType();
+            // Objects the camera has left behind, and projectiles that left
+            // the view, are never seen again
+            if (SleepsOutOfBand(type) && current_game_object->GetParent().IsNull() &&
+                current_game_object->GetPosition().y < camera_position_.y - activation_behind_g) {
+                current_game_object->SetAlive(false);
+            }
+            else if (IsProjectile(type) && HasLeftView(current_game_object, camera_position_)) {
+                current_game_object->SetAlive(false);
             }
+            if (!current_game_object->GetAlive() && !current_game_object->GetDying()) {
+                to_erase_.push_back(current_game_object->GetHandle());
+                // Attached particle systems render relative to their parent, so they go with it
+                if (!current_game_object->GetParticles().IsNull()) {
+                    to_erase_.push_back(current_game_object->GetParticles());
+                }
+            }
+        }
+
+        // Remove game objects save in the to_erase vector
+        // A handle may be listed twice, the second lookup finds nothing
+        for (int i = 0; i < to_erase_.size(); i++){
+            RemoveGameObject(to_erase_[i]);
         }
     }
 
     if (player_dead_) {
         std::cout << "Mission failed, comrade." << std::endl;
-        glfwSetWindowShouldClose(window_, true);
+        Quit();
     }
     else {
         if (boss_dead_) {
             std::cout << "Mission accomplished, comrade." << std::endl;
-            glfwSetWindowShouldClose(window_, true);
+            Quit();
+        }
+    }
+
+    // Scroll the camera
+    camera_position_ += (float)delta_time * glm::vec3(0.0f, scroll_speed_g, 0.0f);
+}
+
+
+void Game::SpawnWaveEvent(const WaveEvent &event)
+{
+    GameObject *player = GetGameObject(player_handle_);
+    float pi_over_two = glm::pi<float>() / 2.0f;
+    glm::vec3 position = camera_position_ + glm::vec3(event.offset, 0.0f);
+
+    switch (event.type) {
+        case WaveMine: {
+            MineEnemyObject* mine = new MineEnemyObject(position, sprite_, &sprite_shader_, tex_[11], 1.0f, 1.0f, event.health, camera_position_ + glm::vec3(event.orbit, 0.0f));
+            mine->SetVelocity(glm::vec3(0.0, 1.0, 0.0));
+            mine->SetScale(event.scale);
+            mine->SetType(MineObj);
+            AddGameObject(mine);
+            break;
+        }
+        case WaveSub: {
+            SubEnemyObject* sub = new SubEnemyObject(position, sprite_, &sprite_shader_, tex_[13], 0.6f, 1.8f, event.health);
+            sub->SetTarget(player);
+            sub->SetRotation(3 * pi_over_two);
+            sub->SetScale(event.scale);
+            sub->SetType(SubObj);
+            AddGameObject(sub);
+            break;
+        }
+        case WaveShark: {
+            SharkEnemyObject* shark = new SharkEnemyObject(position, sprite_, &sprite_shader_, tex_[12], 1.0f, 1.0f, event.health);
+            shark->SetTarget(player);
+            shark->SetScale(event.scale);
+            shark->SetType(SharkObj);
+            AddGameObject(shark);
+            break;
+        }
+        case WaveBoss: {
+            BossSubObject* boss = new BossSubObject(position, sprite_, &sprite_shader_, tex_[19], 1.0f, 1.25f, event.health);
+            boss->SetScale(event.scale);
+            boss->SetTarget(player);
+            boss->SetType(BossObj);
+            AddGameObject(boss);
+
+            // The boss comes with its four turrets
+            const float turret_x[] = { -3.55f, -1.95f, 1.95f, 3.55f };
+            for (int i = 0; i < 4; i++) {
+                BossTurretObject* turret = new BossTurretObject(glm::vec3(turret_x[i], 1.4f, -0.5f), sprite_, &sprite_shader_, tex_[16], boss->GetHandle(), glm::vec3(-3.55f, 1.4f, -0.5f), 1.0f, 1.0f, 10);
+                turret->SetTarget(player);
+                turret->SetScale(3.0f);
+                turret->SetRotation(-pi_over_two);
+                turret->SetType(TurretObj);
+                AddGameObject(turret);
+            }
+            break;
+        }
+        case WaveRepairKit:
+        case WaveDamageUpgrade:
+        case WaveInvinciblePower: {
+            const int textures[] = { 20, 22, 21 };
+            const ItemType item_types[] = { RepairKit, DamageUpgrade, InvinciblePower };
+            int item = event.type - WaveRepairKit;
+            ItemGameObject* pickup = new ItemGameObject(position, sprite_, &sprite_shader_, tex_[textures[item]], 1.0f, 1.0f, event.health);
+            pickup->SetItemType(item_types[item]);
+            pickup->SetScale(event.scale);
+            AddGameObject(pickup);
+            break;
+        }
+        case WaveJavelin: {
+            Bullet* bullet = new Bullet(position, sprite_, &sprite_shader_, tex_[9], 1.0f, 1.0f, event.health);
+            bullet->SetVelocity(glm::vec3(0.0f, 18.0f, 0.0f));
+            bullet->SetScale(event.scale);
+            bullet->SetOrigin(position);
+            AddGameObject(bullet);
+            break;
+        }
+        case WaveTrail: {
+            // Without a parent the trail stays where it is put
+            GameObject* particles = new ParticleSystem(position, &particle_pool_, trail_effect_, tex_[4], Handle(), 1.0f, 1.0f, event.health);
+            particles->SetScale(event.scale);
+            particles->SetRotation(-pi_over_two);
+            AddGameObject(particles);
+            break;
         }
     }
 }
 
 
-void Game::Render(double delta_time){
+void Game::GatherCandidateCircles(const std::vector<int> &candidates, double target_factor, CircleBatch &circles) const
+{
+    circles.Clear();
+    for (int j = 0; j < candidates.size(); j++) {
+        GameObject* other_game_object = game_objects_[candidates[j]];
+        ObjectType type = other_game_object->GetType();
+        glm::vec3 center = other_game_object->GetPosition();
+        float radius = 0.0f;
+        if (type == EnemyObj || type == MineObj || type == SharkObj || type == SubObj) {
+            radius = other_game_object->GetScale() * 0.45;
+        }
+        else if (type == TurretObj) {
+            center = static_cast<BossTurretObject*>(other_game_object)->GetFakePosition();
+            radius = other_game_object->GetScale() * target_factor;
+        }
+        else if (type == BossObj) {
+            radius = other_game_object->GetScale() * target_factor;
+        }
+        circles.Add(glm::vec2(center.x, center.y), radius);
+    }
+}
+
+
+void Game::SweepProjectiles(int begin, int end, int thread)
+{
+    SweepBuffer &buffer = sweep_buffers_[thread];
+    for (int p = begin; p < end; p++) {
+        int i = projectiles_[p];
+        Bullet* bullet = static_cast<Bullet*>(game_objects_[i]);
+        // Turrets and the boss are smaller targets for javelins than for torpedoes
+        double target_factor = (bullet->GetType() == BulletObj) ? 0.1 : 0.2;
+        collision_grid_.QuerySegment(bullet->GetSweepStart(), bullet->GetPosition(), 0.0f, buffer.candidates);
+        GatherCandidateCircles(buffer.candidates, target_factor, buffer.circles);
+        bullet->CheckCollisions(buffer.circles);
+        for (int j = 0; j < buffer.candidates.size(); j++) {
+            if (buffer.circles.GetHit(j)) {
+                SweepHit hit = { i, buffer.candidates[j] };
+                buffer.hits.push_back(hit);
+            }
+        }
+    }
+}
+
+void Game::ApplyDamage(const DamageEvent &event)
+{
+    GameObject* target = GetGameObject(event.target);
+    GameObject* source = GetGameObject(event.source);
+    if (target == nullptr || source == nullptr) return;
+
+    if (target->GetType() == PlayerObj) {
+        // Enemy shots are spent on the player, and stop hurting once the
+        // mission is accomplished; running into enemies always hurts
+        bool shot = IsProjectile(source->GetType());
+        if (!target->GetInvincible() && !(shot && mission_complete_)) {
+            if (target->TakeDamage(event.amount) == true) {
+                KillEvent kill = { event.target, event.source };
+                ApplyKill(kill);
+            }
+        }
+        if (shot) source->SetAlive(false);
+        return;
+    }
+
+    // The player's weapons, made stronger by upgrades
+    // The boss can't be damaged while it has turrets left
+    if (target->GetType() == BossObj && turret_killcount_ < 4) return;
+    if (target->TakeDamage(event.amount * damage_factor_) == true) {
+        // Applied now, since the next events depend on it
+        KillEvent kill = { event.target, event.source };
+        ApplyKill(kill);
+    }
+    source->SetAlive(false);
+}
+
+
+void Game::ApplyKill(const KillEvent &event)
+{
+    GameObject* target = GetGameObject(event.target);
+    GameObject* cause = GetGameObject(event.cause);
+    if (target == nullptr || cause == nullptr) return;
+    ObjectType type = target->GetType();
+
+    if (type == PlayerObj) {
+        StartDeath(target, 1.0);
+        RequestBanner("M I S S I O N  F A I L E D", 1.0);
+    }
+    else if (type == TurretObj) {
+        killcount_++;
+        turret_killcount_++;
+        StartDeath(target, 0.25);
+        if (turret_killcount_ >= 4) {
+            boss_vuln_ = true;
+        }
+    }
+    else if (type == BossObj) {
+        // The wreck of a boss sunk by a torpedo stays longer
+        StartDeath(target, (cause->GetType() == TorpedoObj) ? 5.0 : 3.0);
+        RequestExplosion(event.target, glm::vec3(0.0f, 0.0f, -2.0f), 0.8f);
+        mission_complete_ = true;
+        RequestBanner("MISSION ACCOMPLISHED", 3.0);
+    }
+    else if (cause->GetType() == PlayerObj) {
+        // Enemies the player ran into; only mines leave a wreck
+        target->SetAlive(false);
+        killcount_++;
+        if (type == MineObj) StartDeath(target, 0.15);
+        RequestExplosion(event.target, glm::vec3(0.0f, 1.0f, -2.0f), 0.25f);
+    }
+    else {
+        killcount_++;
+        StartDeath(target, 0.15);
+        RequestExplosion(event.target, glm::vec3(0.0f, 0.0f, -2.0f), 0.25f);
+
+        // Every 15th kill drops a power-up, where the enemy was for a
+        // javelin and ahead of the camera for a torpedo
+        if (killcount_ % 15 == 0) {
+            SpawnRequest power_up = { SpawnPowerUp, Handle(), target->GetPosition(), 1.5f, nullptr, 0.0 };
+            if (cause->GetType() == TorpedoObj) power_up.position = camera_position_ + glm::vec3(0.0f, 2.0f, 0.0f);
+            events_.Request(power_up);
+        }
+    }
+}
+
+
+void Game::ApplyScore(const ScoreEvent &event)
+{
+    ItemGameObject* item = static_cast<ItemGameObject*>(GetGameObject(event.item));
+    PlayerGameObject* player = static_cast<PlayerGameObject*>(GetGameObject(player_handle_));
+    if (item == nullptr || player == nullptr) return;
+
+    score_ += event.points;
+    if (item->GetItemType() == RepairKit) {
+        player->RepairHealth(player->GetMaxHealth() / 2);
+    }
+    else if (item->GetItemType() == DamageUpgrade) {
+        damage_factor_++;
+    }
+    else if (item->GetItemType() == InvinciblePower) {
+        player->PowerUp();
+        StartTimer(player, PowerUpTimer, 10.0);
+        player->SetTexture(tex_[18]);
+    }
+    item->SetAlive(false);
+}
+
+
+void Game::RequestExplosion(const Handle &parent, const glm::vec3 &offset, float scale)
+{
+    SpawnRequest explosion = { SpawnExplosion, parent, offset, scale, nullptr, 0.0 };
+    events_.Request(explosion);
+}
+
+
+void Game::RequestBanner(const char *text, double lifetime)
+{
+    SpawnRequest banner = { SpawnBanner, Handle(), glm::vec3(0.0f, 2.75f, -1.0f), 1.0f, text, lifetime };
+    events_.Request(banner);
+}
+
+
+void Game::Spawn(const SpawnRequest &request)
+{
+    switch (request.kind) {
+        case SpawnExplosion: {
+            GameObject* parent = GetGameObject(request.parent);
+            if (parent == nullptr) break;
+            ParticleSystem* explosion = new ParticleSystem(request.position, &particle_pool_, explosion_effect_, tex_[4], request.parent, 1.0f, 1.0f, 1);
+            explosion->SetScale(request.scale);
+            explosion->SetType(PSystemExplosionObj);
+            AddGameObject(explosion);
+            parent->SetParticles(explosion->GetHandle());
+            break;
+        }
+        case SpawnPowerUp: {
+            ItemGameObject* powerUp = new ItemGameObject(request.position, sprite_, &sprite_shader_, tex_[21], 1.0f, 1.0f, 1);
+            powerUp->SetItemType(InvinciblePower);
+            powerUp->SetScale(request.scale);
+            AddGameObject(powerUp);
+            break;
+        }
+        case SpawnBanner: {
+            // Banners are placed relative to the camera when they appear
+            TextGameObject* banner = new TextGameObject(camera_position_ + request.position, sprite_, &text_shader_, tex_[17], 0.5f, 10.7f, 1);
+            banner->SetType(ExplainObj);
+            banner->SetVelocity(glm::vec3(0.0f, 1.0f, 0.0f));
+            banner->SetText(request.text);
+            AddGameObject(banner);
+            banner->SetAlive(false);
+            StartDeath(banner, request.lifetime);
+            break;
+        }
+    }
+}
+
+
+
+void Game::GroupByType(void)
+{
+    for (int type = 0; type < NumObjectTypes; type++) {
+        archetypes_[type].clear();
+    }
+    float band_top = camera_position_.y + activation_ahead_g;
+    for (int i = 0; i < game_objects_.Size(); i++) {
+        GameObject *object = game_objects_[i];
+        if (SleepsOutOfBand(object->GetType()) && object->GetParent().IsNull()) {
+            object->SetAwake(object->GetPosition().y <= band_top);
+        }
+    }
+
+    // Parents are all settled now, so the attached objects can follow the
+    // object at the root of their chain; one whose parent is gone keeps
+    // its flag until it is removed
+    for (int i = 0; i < game_objects_.Size(); i++) {
+        GameObject *object = game_objects_[i];
+        GameObject *root = object;
+        while (root != nullptr && !root->GetParent().IsNull()) {
+            root = GetGameObject(root->GetParent());
+        }
+        if (root != nullptr && root != object) {
+            object->SetAwake(root->GetAwake());
+        }
+        if (!object->GetAwake()) continue;
+        archetypes_[object->GetType()].push_back(object);
+    }
+}
+
+
+void Game::UpdateObjects(std::vector<GameObject*> &objects, double delta_time)
+{
+    jobs_.ParallelFor((int)objects.size(), update_grain_g, [&](int begin, int end, int /*thread*/) {
+        for (int i = begin; i < end; i++) {
+            objects[i]->Update(delta_time);
+        }
+    });
+}
+
+
+// Wandering enemies draw from std::rand(), so they are updated in order
+void Game::UpdateEnemies(std::vector<GameObject*> &objects, double delta_time)
+{
+    for (int i = 0; i < objects.size(); i++) {
+        objects[i]->Update(delta_time);
+    }
+}
+
+
+void Game::UpdatePlayers(std::vector<GameObject*> &objects, double delta_time)
+{
+    for (int i = 0; i < objects.size(); i++) {
+        PlayerGameObject* player = static_cast<PlayerGameObject*>(objects[i]);
+        player->Update(delta_time, camera_position_);
+        if (!player->GetAlive() && !player->GetDying()) player_dead_ = true;
+    }
+}
+
+
+// Updates sub enemies, also implements combat behaviour
+// Subs only move themselves, so they are updated in parallel, then fire in order
+void Game::UpdateSubs(std::vector<GameObject*> &objects, double delta_time)
+{
+    jobs_.ParallelFor((int)objects.size(), update_grain_g, [&](int begin, int end, int /*thread*/) {
+        for (int i = begin; i < end; i++) {
+            static_cast<SubEnemyObject*>(objects[i])->Update(delta_time, camera_position_);
+        }
+    });
+    for (int i = 0; i < objects.size(); i++) {
+        SubEnemyObject* sub = static_cast<SubEnemyObject*>(objects[i]);
+        if (sub->GetAlive()) {
+            if (sub->GetShotReady()) {
+                Bullet* torpedo1 = new Bullet(sub->GetPosition(), sprite_, &sprite_shader_, tex_[14], 1.0f, 1.0f, 1);
+                torpedo1->SetRotation(sub->GetRotation() + glm::pi<float>() / 4.0);
+                torpedo1->SetVelocity(3.0f * sub->GetBottomRight());
+                torpedo1->SetScale(0.75f);
+                torpedo1->SetOrigin(sub->GetPosition() - glm::vec3(0.0f, 0.55f, 0.0f));
+                torpedo1->SetType(SubTorpedoObj);
+                AddGameObject(torpedo1);
+
+                GameObject* particles1 = new ParticleSystem(glm::vec3(-0.45f, 0.0f, 0.0f), &particle_pool_, trail_effect_, tex_[4], torpedo1->GetHandle(), 1.0f, 1.0f, 1);
+                particles1->SetScale(0.1);
+                particles1->SetRotation(sub->GetRotation());
+                AddGameObject(particles1);
+                torpedo1->SetParticles(particles1->GetHandle());
+
+                Bullet* torpedo2 = new Bullet(sub->GetPosition(), sprite_, &sprite_shader_, tex_[14], 1.0f, 1.0f, 1);
+                torpedo2->SetRotation(sub->GetRotation() - glm::pi<float>() / 4.0);
+                torpedo2->SetVelocity(3.0f * sub->GetBottomLeft());
+                torpedo2->SetScale(0.75f);
+                torpedo2->SetOrigin(sub->GetPosition() - glm::vec3(0.0f, 0.55f, 0.0f));
+                torpedo2->SetType(SubTorpedoObj);
+                AddGameObject(torpedo2);
+                sub->SetShotReady(false);
+                StartTimer(sub, ShotTimer, 3.0);
+
+                GameObject* particles2 = new ParticleSystem(glm::vec3(-0.45f, 0.0f, 0.0f), &particle_pool_, trail_effect_, tex_[4], torpedo2->GetHandle(), 1.0f, 1.0f, 1);
+                particles2->SetScale(0.1);
+                particles2->SetRotation(sub->GetRotation());
+                AddGameObject(particles2);
+                torpedo2->SetParticles(particles2->GetHandle());
+            }
+        }
+    }
+}
+
+
+// Updates the boss, implements combat behaviour
+void Game::UpdateBosses(std::vector<GameObject*> &objects, double delta_time)
+{
+    for (int i = 0; i < objects.size(); i++) {
+        BossSubObject* boss = static_cast<BossSubObject*>(objects[i]);
+        boss->Update(delta_time, camera_position_);
+        if (boss->GetAlive()) {
+            if (boss->GetShotReady()) {
+                Bullet* torpedo1 = new Bullet(boss->GetPosition(), sprite_, &sprite_shader_, tex_[14], 1.0f, 1.0f, 1);
+                torpedo1->SetRotation(boss->GetRotation() - (3 * glm::pi<float>()) / 4.0);
+                torpedo1->SetVelocity(3.0f * -boss->GetBottomRight());
+                torpedo1->SetScale(0.75f);
+                torpedo1->SetOrigin(boss->GetPosition() + glm::vec3(0.0f, 0.8f, 0.0f));
+                torpedo1->SetType(SubTorpedoObj);
+                AddGameObject(torpedo1);
+
+                GameObject* particles1 = new ParticleSystem(glm::vec3(-0.45f, 0.0f, 0.0f), &particle_pool_, trail_effect_, tex_[4], torpedo1->GetHandle(), 1.0f, 1.0f, 1);
+                particles1->SetScale(0.1);
+                particles1->SetRotation(torpedo1->GetRotation() + glm::pi<float>() / 4.0);
+                AddGameObject(particles1);
+                torpedo1->SetParticles(particles1->GetHandle());
+
+                Bullet* torpedo2 = new Bullet(boss->GetPosition(), sprite_, &sprite_shader_, tex_[14], 1.0f, 1.0f, 1);
+                torpedo2->SetRotation(boss->GetRotation() - glm::pi<float>() / 4.0);
+                torpedo2->SetVelocity(3.0f * boss->GetBottomLeft());
+                torpedo2->SetScale(0.75f);
+                torpedo2->SetOrigin(boss->GetPosition() + glm::vec3(0.0f, 0.8f, 0.0f));
+                torpedo2->SetType(SubTorpedoObj);
+                AddGameObject(torpedo2);
+
+                GameObject* particles2 = new ParticleSystem(glm::vec3(-0.45f, 0.0f, 0.0f), &particle_pool_, trail_effect_, tex_[4], torpedo2->GetHandle(), 1.0f, 1.0f, 1);
+                particles2->SetScale(0.1);
+                particles2->SetRotation(torpedo2->GetRotation() - glm::pi<float>() / 4.0);
+                AddGameObject(particles2);
+                torpedo2->SetParticles(particles2->GetHandle());
+
+                Bullet* torpedo3 = new Bullet(boss->GetPosition(), sprite_, &sprite_shader_, tex_[14], 1.0f, 1.0f, 1);
+                torpedo3->SetRotation(boss->GetRotation() - glm::pi<float>() / 2.0);
+                torpedo3->SetVelocity(3.0f * boss->GetRight());
+                torpedo3->SetScale(0.75f);
+                torpedo3->SetOrigin(boss->GetPosition() + glm::vec3(0.0f, 0.8f, 0.0f));
+                torpedo3->SetType(SubTorpedoObj);
+                AddGameObject(torpedo3);
+                boss->SetShotReady(false);
+                if (turret_killcount_ < 2) StartTimer(boss, ShotTimer, 3.0);
+                else if (turret_killcount_ < 3) StartTimer(boss, ShotTimer, 2.5);
+                else if (turret_killcount_ < 4) StartTimer(boss, ShotTimer, 2.0);
+                else StartTimer(boss, ShotTimer, 1.0);
+
+                GameObject* particles3 = new ParticleSystem(glm::vec3(-0.45f, 0.0f, 0.0f), &particle_pool_, trail_effect_, tex_[4], torpedo3->GetHandle(), 1.0f, 1.0f, 1);
+                particles3->SetScale(0.1);
+                particles3->SetRotation(torpedo3->GetRotation());
+                AddGameObject(particles3);
+                torpedo3->SetParticles(particles3->GetHandle());
+            }
+        }
+        if (!boss->GetAlive() && !boss->GetDying()) boss_dead_ = true;
+        if (boss_vuln_ == true) boss->SetTexture(tex_[15]);
+    }
+}
+
+
+// Updates sharks and fires their bullets
+// Steering only reads the player, so the sharks are updated in parallel
+// and fire after, in order
+void Game::UpdateSharks(std::vector<GameObject*> &objects, double delta_time)
+{
+    jobs_.ParallelFor((int)objects.size(), update_grain_g, [&](int begin, int end, int /*thread*/) {
+        for (int i = begin; i < end; i++) {
+            static_cast<SharkEnemyObject*>(objects[i])->Update(delta_time);
+        }
+    });
+    for (int i = 0; i < objects.size(); i++) {
+        SharkEnemyObject* shark = static_cast<SharkEnemyObject*>(objects[i]);
+        if (shark->GetAlive()) {
+            if (shark->GetShotReady()) {
+                Bullet* bullet = new Bullet(shark->GetPosition(), sprite_, &sprite_shader_, tex_[9], 1.0f, 1.0f, 1);
+                bullet->SetRotation(shark->GetRotation() - glm::pi<float>() / 2.0);
+                bullet->SetVelocity(4.0f * shark->GetBearing());
+                bullet->SetOrigin(shark->GetPosition());
+                bullet->SetType(SharkBulletObj);
+                AddGameObject(bullet);
+                shark->SetShotReady(false);
+                StartTimer(shark, ShotTimer, 1.5);
+            }
+        }
+    }
+}
+
+
+// Updates boss turrets and fires their bullets, like sharks
+void Game::UpdateTurrets(std::vector<GameObject*> &objects, double delta_time)
+{
+    jobs_.ParallelFor((int)objects.size(), update_grain_g, [&](int begin, int end, int /*thread*/) {
+        for (int i = begin; i < end; i++) {
+            static_cast<BossTurretObject*>(objects[i])->Update(delta_time);
+        }
+    });
+    for (int i = 0; i < objects.size(); i++) {
+        BossTurretObject* turret = static_cast<BossTurretObject*>(objects[i]);
+        if (turret->GetAlive()) {
+            if (turret->GetShotReady()) {
+                Bullet* bullet = new Bullet(turret->GetFakePosition(), sprite_, &sprite_shader_, tex_[9], 1.0f, 1.0f, 1);
+                bullet->SetRotation(turret->GetRotation());
+                bullet->SetVelocity(5.0f * -turret->GetRight());
+                bullet->SetOrigin(turret->GetFakePosition());
+                bullet->SetType(SharkBulletObj);
+                AddGameObject(bullet);
+                turret->SetShotReady(false);
+                StartTimer(turret, ShotTimer, 2.0);
+            }
+        }
+    }
+}
+
+
+void Game::Render(const RenderSnapshot &snapshot, double time){
+
+    // Follow the size of the window
+    if (snapshot.framebuffer_width != viewport_width_ || snapshot.framebuffer_height != viewport_height_) {
+        viewport_width_ = snapshot.framebuffer_width;
+        viewport_height_ = snapshot.framebuffer_height;
+        glViewport(0, 0, viewport_width_, viewport_height_);
+    }
+
+    // Blend between the last two simulation steps by the time since the
+    // last one, which keeps growing until the next snapshot; past a step,
+    // the last step is drawn as it is
+    double lag = std::min(snapshot.lag + (time - snapshot.time), sim_time_step_g);
+    float alpha = (float)(lag / sim_time_step_g);
 
     // Clear background
     glClearColor(viewport_background_color_g.r,
@@ -1324,8 +1777,8 @@ void Game::Render(double delta_time){
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     // Use aspect ratio to properly scale the window
-    int width, height;
-    glfwGetWindowSize(window_, &width, &height);
+    int width = snapshot.window_width;
+    int height = snapshot.window_height;
     glm::mat4 window_scale_matrix;
     if (width > height){
         float aspect_ratio = ((float) width)/((float) height);
@@ -1336,14 +1789,105 @@ void Game::Render(double delta_time){
     }
 
     // Set view to zoom out, centered by default at 0,0
-    float camera_zoom = 0.25f;
-    glm::mat4 camera_zoom_matrix = glm::scale(glm::mat4(1.0f), glm::vec3(camera_zoom, camera_zoom, camera_zoom));
-    camera_position_ += (float)delta_time * glm::vec3(0.0f, 1.0f, 0.0f);
+    glm::mat4 camera_zoom_matrix = glm::scale(glm::mat4(1.0f), glm::vec3(camera_zoom_g, camera_zoom_g, camera_zoom_g));
+    glm::vec3 camera_position = snapshot.previous_camera_position + alpha * (snapshot.camera_position - snapshot.previous_camera_position);
     //glm::mat4 view_matrix = window_scale_matrix * camera_zoom_matrix;
-    glm::mat4 view_matrix = window_scale_matrix * camera_zoom_matrix * glm::translate(glm::mat4(1.0f), -camera_position_);
-    // Render all game objects
-    for (int i = 0; i < game_objects_.size(); i++) {
-        game_objects_[i]->Render(view_matrix, current_time_);
+    glm::mat4 view_matrix = window_scale_matrix * camera_zoom_matrix * glm::translate(glm::mat4(1.0f), -camera_position);
+
+    // Blend every object between its last two states before drawing,
+    // since children are drawn relative to their blended parents
+    int num_objects = snapshot.overlay_start;
+    draw_items_.resize(num_objects);
+    for (int i = 0; i < num_objects; i++) {
+        PlaceDrawItem(snapshot.records[i], alpha, draw_items_[i]);
+    }
+    for (int i = 0; i < num_objects; i++) {
+        int parent = snapshot.records[i].parent;
+        if (parent >= 0) {
+            draw_items_[i].parent_position = draw_items_[parent].position;
+            draw_items_[i].parent_angle = draw_items_[parent].angle;
+        }
+    }
+
+    // Part of the world in view, as its half size around the camera
+    glm::vec2 view_half_size(1.0f / camera_zoom_g);
+    if (width > height) view_half_size.x *= (float)width / height;
+    else view_half_size.y *= (float)height / width;
+
+    // Render all game objects, layer by layer (see RenderLayer)
+    // Objects entirely out of view are left out
+    sprite_batch_.Begin(view_matrix);
+    particle_pool_.Begin(view_matrix);
+    render_queue_.Clear();
+    for (int i = 0; i < num_objects; i++) {
+        const DrawItem &item = draw_items_[i];
+        if (!item.record->awake) continue;
+        glm::vec2 center, half_size;
+        GetDrawBounds(item, center, half_size);
+        if (fabs(center.x - camera_position.x) - half_size.x > view_half_size.x ||
+            fabs(center.y - camera_position.y) - half_size.y > view_half_size.y) {
+            continue;
+        }
+        render_queue_.Add(GetRenderLayer(item.record->type), &item);
+    }
+    render_queue_.Sort();
+    render_queue_.Submit(snapshot, sprite_batch_, view_matrix);
+
+    // Particles go on top of everything, in one draw
+    particle_pool_.Flush();
+
+    if (snapshot.show_profile) RenderProfileOverlay(snapshot, view_matrix, camera_position);
+}
+
+
+// Size of a character of the overlay, and where its first line starts
+// relative to the camera
+const float profile_char_height_g = 0.25f;
+const float profile_char_width_g = 0.15f;
+const glm::vec2 profile_origin_g(-5.2f, 3.7f);
+// Depth of the overlay, in front of the HUD text at -1 and everything
+// behind it, since text is drawn with the depth test on
+const float profile_depth_g = -2.0f;
+// Characters of every line, so all lines are drawn at the same scale
+const int profile_line_length_g = 31;
+
+
+void Game::InitProfileOverlay(void)
+{
+    // A header, then one line per zone, at their position relative to the
+    // camera
+    float half_width = 0.5f * profile_char_width_g * profile_line_length_g;
+    for (int i = 0; i <= NumProfileZones; i++) {
+        glm::vec2 offset = profile_origin_g + glm::vec2(half_width, -i * profile_char_height_g);
+        TextGameObject *line = new TextGameObject(glm::vec3(offset, profile_depth_g), sprite_, &text_shader_, tex_[10], profile_char_height_g, profile_char_width_g * profile_line_length_g, 1);
+        profile_lines_.push_back(line);
+    }
+}
+
+
+void Game::UpdateProfileOverlay(void)
+{
+    char text[TEXT_LENGTH + 1];
+    // Times in microseconds
+    snprintf(text, sizeof(text), "%-10s %6s %6s %6s", "us", "min", "avg", "p99");
+    profile_lines_[0]->SetText(text);
+    for (int zone = 0; zone < NumProfileZones; zone++) {
+        Profiler::Stats stats = profiler_.GetStats((ProfileZone)zone);
+        snprintf(text, sizeof(text), "%-10s %6.0f %6.0f %6.0f", Profiler::GetZoneName((ProfileZone)zone),
+            stats.min * 1.0e6, stats.average * 1.0e6, stats.p99 * 1.0e6);
+        profile_lines_[zone + 1]->SetText(text);
+    }
+}
+
+
+void Game::RenderProfileOverlay(const RenderSnapshot &snapshot, const glm::mat4 &view_matrix, const glm::vec3 &camera_position)
+{
+    // Drawn over everything else by its depth, see profile_depth_g
+    for (int i = snapshot.overlay_start; i < snapshot.records.size(); i++) {
+        DrawItem item;
+        PlaceDrawItem(snapshot.records[i], 1.0f, item);
+        item.position = camera_position + snapshot.records[i].position;
+        render_queue_.Draw(item, snapshot, sprite_batch_, view_matrix);
     }
 }
       
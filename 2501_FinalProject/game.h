@@ -4,10 +4,27 @@
 #define GLEW_STATIC
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
+#include <thread>
 #include <vector>
 
 #include "shader.h"
 #include "game_object.h"
+#include "clock.h"
+#include "spatial_hash.h"
+#include "ray_circle.h"
+#include "job_system.h"
+#include "event_bus.h"
+#include "slot_map.h"
+#include "motion_store.h"
+#include "sprite_batch.h"
+#include "particle_pool.h"
+#include "texture_atlas.h"
+#include "render_queue.h"
+#include "render_snapshot.h"
+#include "timer_wheel.h"
+#include "wave_timeline.h"
+#include "profiler.h"
+#include "text_game_object.h"
 
 namespace game {
 
@@ -26,29 +43,113 @@ namespace game {
             // Set up the game (scene, game objects, etc.)
             void Setup(void);
 
+            // Read the enemy waves from another wave file than the game's,
+            // or from none if the name is empty
+            // Call before Setup()
+            inline void SetWaveFile(const std::string &filename) { wave_file_ = filename; }
+
             // Run the game (keep the game active)
             void MainLoop(void); 
 
+            // Draw frames on a thread of their own, which takes the OpenGL
+            // context (the default), or on the main thread after each
+            // round of simulation steps. Call before MainLoop()
+            inline void SetRenderThread(bool render_thread) { render_thread_ = render_thread; }
+
+            // Call InitHeadless() instead of Init() to run the game without
+            // a window or OpenGL context: only the simulation runs, there
+            // is no input and nothing is rendered
+            void InitHeadless(void);
+
+            // Run the simulation without a window, as fast as possible,
+            // for the given amount of game time in fixed time steps
+            void RunHeadless(double duration, double time_step);
+
+            // Run one simulation step without a window
+            void Step(double time_step);
+
+            // Add the object of a wave event to the game now, whatever its
+            // time; scripted scenarios such as bench_sim set up the game with it
+            void SpawnWaveEvent(const WaveEvent &event);
+
+            // Keep the player from taking damage for the rest of the game,
+            // so a scripted scenario runs for as long as it is asked to
+            void SetPlayerInvincible(void);
+
+            inline int GetNumObjects(void) const { return game_objects_.Size(); }
+
+            // Objects of a type that were awake in the last step; sleeping
+            // objects are not updated, so they neither move nor shoot
+            int GetNumAwake(ObjectType type) const;
+
+            // Threads the simulation runs on, the main one included, or 0
+            // (the default) for one per core; the results are the same
+            // for any number. Call before Init() or InitHeadless()
+            inline void SetNumThreads(int num_threads) { num_threads_ = num_threads; }
+
+            // Most objects expected alive at once; room for them is made up
+            // front so spawning never reallocates the object stores. Call
+            // before Init() or InitHeadless()
+            inline void SetCapacity(int max_objects) { max_objects_ = max_objects; }
+
+            // Hash of the game state and of every object's, so runs with
+            // different numbers of threads can be checked to match
+            unsigned long long GetChecksum(void) const;
+
         private:
             // Main window: pointer to the GLFW window structure
             GLFWwindow *window_;
 
-            // Sprite geometry
-            Geometry *sprite_;
+            // Running without a window or OpenGL context
+            bool headless_;
+
+            // Set when the game ends (player or boss destroyed)
+            bool quit_;
 
-            // Particle geometry
-            Geometry *particles_;
+            // Simulation time, advanced by every step; drives the timers
+            SimulationClock sim_clock_;
 
-            Geometry* explosion_particles_;
+            // Timers of the game objects, see ObjectTimer
+            TimerWheel timers_;
 
-            // Tile geometry
-            Geometry* tile_;
+            // Timers that expired in the current step
+            std::vector<TimerEvent> expired_timers_;
+
+            // Sprite geometry
+            Geometry *sprite_;
 
             // Shader for rendering sprites in the scene
             Shader sprite_shader_;
 
-            // Shader for rendering particles
-            Shader particle_shader_;
+            // The game publishes a snapshot of what it draws after its steps,
+            // and the renderer draws the newest one
+            SnapshotBuffer snapshots_;
+
+            // Thread drawing the snapshots, if frames are drawn on a thread
+            // of their own; it owns the OpenGL context while it runs
+            bool render_thread_;
+            std::thread renderer_;
+
+            // Snapshot records placed for the frame being drawn; like the
+            // sprite batch, render queue, particle pool and shaders, only
+            // the renderer uses them
+            std::vector<DrawItem> draw_items_;
+
+            // Size of the OpenGL viewport, set when the window's changes
+            int viewport_width_;
+            int viewport_height_;
+
+            // Sprites of the current frame, drawn one texture at a time
+            SpriteBatch sprite_batch_;
+
+            // Draws of the current frame, sorted by layer and render state
+            RenderQueue render_queue_;
+
+            // Particles of all particle systems, drawn together, and the
+            // indices of the effects in the pool
+            ParticlePool particle_pool_;
+            int trail_effect_;
+            int explosion_effect_;
 
             Shader text_shader_;
 
@@ -56,10 +157,97 @@ namespace game {
 
             // References to textures
             // This needs to be a pointer
-            GLuint *tex_;
-
-            // List of game objects
-            std::vector<GameObject*> game_objects_;
+            // Sprite textures are regions of the atlas pages
+            TextureRegion *tex_;
+
+            // Pages holding the sprite textures
+            TextureAtlas atlas_;
+
+            // All game objects, referred to by handle
+            SlotMap<GameObject*> game_objects_;
+
+            // Objects the game looks up directly
+            Handle player_handle_;
+            Handle background_handle_;
+            Handle timer_text_handle_;
+            Handle health_text_handle_;
+            Handle score_text_handle_;
+
+            // Broad phase for collisions, rebuilt every step
+            SpatialHash collision_grid_;
+
+            // Objects returned by the last collision grid query
+            std::vector<int> candidates_;
+
+            // Threads running the update systems and the projectile sweeps
+            JobSystem jobs_;
+            int num_threads_;
+
+            // Objects the stores are sized for, see SetCapacity()
+            int max_objects_;
+
+            // A projectile's sweep hitting an object, by their indices in
+            // game_objects_; sorted by projectile, then by object
+            struct SweepHit {
+                int projectile;
+                int target;
+                inline bool operator<(const SweepHit &other) const {
+                    return projectile < other.projectile || (projectile == other.projectile && target < other.target);
+                }
+            };
+
+            // What a thread needs to sweep projectiles: its grid query, the
+            // circles of the candidates, tested at once, and the hits it
+            // found, applied by the main thread once all threads are done
+            struct SweepBuffer {
+                std::vector<int> candidates;
+                CircleBatch circles;
+                std::vector<SweepHit> hits;
+            };
+            std::vector<SweepBuffer> sweep_buffers_;
+
+            // Player javelins and torpedoes of the step, and the hits of
+            // all of them, in the order the projectiles are met
+            std::vector<int> projectiles_;
+            std::vector<SweepHit> sweep_hits_;
+
+            // Gameplay events of the step, from detecting collisions to
+            // applying them
+            EventBus events_;
+
+            // Sweeps of the enemy shots of the step, tested against the
+            // player at once
+            RayBatch shark_shots_;
+            RayBatch sub_torpedoes_;
+
+            // Positions and velocities of the objects moving in a straight line
+            MotionStore motion_;
+
+            // Objects grouped by type, rebuilt at the start of every step
+            std::vector<GameObject*> archetypes_[NumObjectTypes];
+
+            // System updating the objects of each type
+            typedef void (Game::*UpdateSystem)(std::vector<GameObject*> &objects, double delta_time);
+            UpdateSystem update_systems_[NumObjectTypes];
+
+            // Time spent in each part of the last frames, and the zone of
+            // each object type's update system
+            Profiler profiler_;
+            ProfileZone update_zones_[NumObjectTypes];
+
+            // Lines of the profiler overlay, toggled with F3
+            // They are not game objects, so they don't change the simulation
+            std::vector<TextGameObject*> profile_lines_;
+            bool show_profile_;
+            bool profile_key_down_;
+
+            // Objects to remove at the end of the step, kept between steps
+            // so its memory is reused
+            std::vector<Handle> to_erase_;
+
+            // Enemy waves still to come, and the file they are read from
+            WaveTimeline waves_;
+            std::string wave_file_;
 
             // Keep track of time
             double current_time_;
@@ -79,18 +267,44 @@ namespace game {
             bool mission_complete_;
 
             glm::vec3 camera_position_;
+            glm::vec3 previous_camera_position_;
             glm::vec3 cam_velocity_;
 
             // Shooting cool down
             double next_shot_;
             double next_torpedo_;
 
-            // Callback for when the window is resized
-            static void ResizeCallback(GLFWwindow* window, int width, int height);
+            // Initialize the game state shared by Init() and InitHeadless()
+            void InitGameState(void);
+
+            // End the game
+            void Quit(void);
+
+            // Store a new game object and give it its handle
+            Handle AddGameObject(GameObject *object);
+
+            // Get the game object a handle refers to, or nullptr if it was removed
+            GameObject *GetGameObject(const Handle &handle);
+
+            // Delete a game object and remove it from the game
+            void RemoveGameObject(const Handle &handle);
+
+            // Start one of an object's timers, replacing the one running
+            void StartTimer(GameObject *object, ObjectTimer kind, double delay);
+
+            // Keep a dead object in the game for delay seconds
+            void StartDeath(GameObject *object, double delay);
+
+            // Apply the effect of an expired timer to its object
+            void ExpireTimer(const TimerEvent &event);
 
             // Set a specific texture
             void SetTexture(GLuint w, const char *fname, bool background);
 
+            // Load a texture into the atlas and get its region index,
+            // -1 if it could not be loaded
+            int AddToAtlas(const char *fname);
+
             // Load all textures
             void SetAllTextures();
 
@@ -99,9 +313,78 @@ namespace game {
 
             // Update all the game objects
             void Update(double delta_time);
+
+            // Put the circles of the collision candidates in circles,
+            // turrets and the boss being target_factor of their scale;
+            // objects that can't be hit get no radius
+            void GatherCandidateCircles(const std::vector<int> &candidates, double target_factor, CircleBatch &circles) const;
+
+            // Sweep projectiles_[begin] to projectiles_[end - 1] against the
+            // collision grid, into the hits of thread's sweep buffer
+            // Only reads the game, so threads sweep at the same time
+            void SweepProjectiles(int begin, int end, int thread);
+
+            // Apply gameplay events; a kill that damage causes is applied
+            // right away, and objects to spawn are requested on events_
+            void ApplyDamage(const DamageEvent &event);
+            void ApplyKill(const KillEvent &event);
+            void ApplyScore(const ScoreEvent &event);
+
+            // Request an explosion attached to parent, or a banner of text
+            void RequestExplosion(const Handle &parent, const glm::vec3 &offset, float scale);
+            void RequestBanner(const char *text, double lifetime);
+
+            // Add the object a spawn request asks for
+            void Spawn(const SpawnRequest &request);
+
+            // Wake the objects the camera has scrolled to, and group the
+            // awake game objects by type into archetypes_
+            void GroupByType(void);
+
+            // Systems, each updating the objects of one type
+            // Types without a dedicated system use UpdateObjects()
+            // Objects that only change themselves are updated in parallel,
+            // and what they spawn is added after, in the order of objects
+            void UpdateObjects(std::vector<GameObject*> &objects, double delta_time);
+            void UpdateEnemies(std::vector<GameObject*> &objects, double delta_time);
+            void UpdatePlayers(std::vector<GameObject*> &objects, double delta_time);
+            void UpdateSubs(std::vector<GameObject*> &objects, double delta_time);
+            void UpdateBosses(std::vector<GameObject*> &objects, double delta_time);
+            void UpdateSharks(std::vector<GameObject*> &objects, double delta_time);
+            void UpdateTurrets(std::vector<GameObject*> &objects, double delta_time);
+
+            // Remember the state of the camera and all game objects before
+            // a simulation step, so rendering can blend between steps
+            void SaveState(void);
+
+            // Copy what the game draws into the back snapshot and publish it
+            // time is the clock time of the frame, and lag the time left
+            // over after its last step
+            void PublishSnapshot(double time, double lag);
+
+            // Draw the newest snapshot and show it
+            // Returns false once the snapshots are closed
+            bool PresentFrame(void);
+
+            // What the render thread runs, until the snapshots are closed
+            void RenderLoop(void);
+
+            // Close the snapshots and join the render thread, if it runs,
+            // and take the OpenGL context back
+            void StopRenderThread(void);
  
-            // Render the game world
-            void Render(double delta_time);
+            // Render a snapshot of the game world at the given clock time,
+            // blended between its last two simulation steps
+            void Render(const RenderSnapshot &snapshot, double time);
+
+            // Create the lines of the profiler overlay
+            void InitProfileOverlay(void);
+
+            // Write the profiler's statistics into the overlay
+            void UpdateProfileOverlay(void);
+
+            // Draw the overlay lines of a snapshot at the top left of the view
+            void RenderProfileOverlay(const RenderSnapshot &snapshot, const glm::mat4 &view_matrix, const glm::vec3 &camera_position);
 
     }; // class Game
 
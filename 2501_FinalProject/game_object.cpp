@@ -3,10 +3,11 @@
 #include <iostream>
 
 #include "game_object.h"
+#include "render_snapshot.h"
 
 namespace game {
 
-GameObject::GameObject(const glm::vec3 &position, Geometry *geom, Shader *shader, GLuint texture, float yScale, float xScale, int health) 
+GameObject::GameObject(const glm::vec3 &position, Geometry *geom, Shader *shader, const TextureRegion &texture, float yScale, float xScale, int health) 
 {
 
     // Initialize all attributes
@@ -15,27 +16,33 @@ GameObject::GameObject(const glm::vec3 &position, Geometry *geom, Shader *shader
     angle_ = 0.0;
     geometry_ = geom;
     shader_ = shader;
-    texture_ = texture;
+    texture_ = texture.texture;
+    uv_rect_ = texture.uv_rect;
     velocity_ = glm::vec3(0.0f, 0.0f, 0.0f);
     type_ = GenericObj;
     yScale_ = yScale;
     xScale_ = xScale;
     health_ = health;
     alive_ = true;
-    particles_ = nullptr;
-    death_timer_ = new Timer();
+    dying_ = false;
+    awake_ = true;
+    lifespan_ = 0.0;
+    shot_ready_ = true;
+    motion_index_ = -1;
+    parent_position_ = glm::vec3(0.0f, 0.0f, 0.0f);
+    parent_angle_ = 0.0f;
     invincible_ = false;
-    powerup_timer_ = new Timer();
+    has_previous_ = false;
+    previous_position_ = position_;
+    previous_angle_ = angle_;
 }
 
 GameObject::~GameObject() {
-
-    if (particles_ != nullptr) particles_->SetAlive(false);
 }
 
 void GameObject::PowerUp(void) {
+    // The game ends it with the power-up timer
     invincible_ = true;
-    powerup_timer_->Start(10);
 }
 
 void GameObject::SetAlive(bool value) {
@@ -90,42 +97,43 @@ void GameObject::SetRotation(float angle){
 
 
 void GameObject::Update(double delta_time) {
-    if (powerup_timer_->Finished()) invincible_ = false;
-    position_ += velocity_*((float) delta_time);
+    if (motion_index_ < 0) position_ += velocity_*((float) delta_time);
 }
 
 
-void GameObject::Render(glm::mat4 view_matrix, double current_time){
-
-    // Set up the shader
-    shader_->Enable();
-
-    // Set up the view matrix
-    shader_->SetUniformMat4("view_matrix", view_matrix);
-
-    // Setup the scaling matrix for the shader
-    glm::mat4 scaling_matrix = glm::scale(glm::mat4(1.0f), glm::vec3(scale_ * xScale_, scale_ * yScale_, 1.0));
+void GameObject::SaveState(void) {
+    has_previous_ = true;
+    previous_position_ = position_;
+    previous_angle_ = angle_;
+}
 
-    // Setup the rotation matrix for the shader
-    glm::mat4 rotation_matrix = glm::rotate(glm::mat4(1.0f), angle_, glm::vec3(0.0, 0.0, 1.0));
 
-    // Set up the translation matrix for the shader
-    glm::mat4 translation_matrix = glm::translate(glm::mat4(1.0f), position_);
+void GameObject::FollowParent(const GameObject& parent) {
+    parent_position_ = parent.position_;
+    parent_angle_ = parent.angle_;
+}
 
-    // Setup the transformation matrix for the shader
-    glm::mat4 transformation_matrix = translation_matrix * rotation_matrix * scaling_matrix;
 
-    // Set the transformation matrix in the shader
-    shader_->SetUniformMat4("transformation_matrix", transformation_matrix);
+void GameObject::Snapshot(RenderSnapshot &snapshot) const {
 
-    // Set up the geometry
-    geometry_->SetGeometry(shader_->GetShaderProgram());
+    DrawRecord &record = snapshot.AddRecord();
+    record.type = type_;
+    record.awake = awake_;
+    record.shader = shader_;
+    record.geometry = geometry_;
+    record.texture = texture_;
+    record.uv_rect = uv_rect_;
 
-    // Bind the entity's texture
-    glBindTexture(GL_TEXTURE_2D, texture_);
+    // Objects created during the last step have no previous state yet
+    record.position = position_;
+    record.angle = angle_;
+    record.previous_position = has_previous_ ? previous_position_ : position_;
+    record.previous_angle = has_previous_ ? previous_angle_ : angle_;
 
-    // Draw the entity
-    glDrawElements(GL_TRIANGLES, geometry_->GetSize(), GL_UNSIGNED_INT, 0);
+    record.size = glm::vec2(scale_ * xScale_, scale_ * yScale_);
+    record.scale = scale_;
+    record.parent_position = parent_position_;
+    record.parent_angle = parent_angle_;
 }
 
 } // namespace game
@@ -7,13 +7,32 @@
 
 #include "shader.h"
 #include "geometry.h"
-#include "timer.h"
+#include "slot_map.h"
+#include "sprite_batch.h"
+#include "texture_atlas.h"
 
 namespace game {
 
+    struct RenderSnapshot;
+
     enum ObjectType { GenericObj, PlayerObj, EnemyObj, MineObj, 
         SharkObj, SubObj, BulletObj, SharkBulletObj, PSystemObj, PSystemExplosionObj,
-        BackgroundObj, ExplainObj, TimerObj, HealthObj, ScoreObj, TorpedoObj, SubTorpedoObj, BossObj, TurretObj, ItemObj };
+        BackgroundObj, ExplainObj, TimerObj, HealthObj, ScoreObj, TorpedoObj, SubTorpedoObj, BossObj, TurretObj, ItemObj,
+        // Number of object types, not a type
+        NumObjectTypes };
+
+    // Timers the game keeps for an object, and what happens when they expire
+    enum ObjectTimer {
+        // The object is removed, once it is dead
+        DeathTimer,
+        // The object is no longer invincible
+        PowerUpTimer,
+        // The object dies
+        LifespanTimer,
+        // The object can shoot again
+        ShotTimer,
+        // Number of timers, not a timer
+        NumObjectTimers };
 
     /*
         GameObject is responsible for handling the rendering and updating of one object in the game world
@@ -23,19 +42,28 @@ namespace game {
 
         public:
             // Constructor
-            GameObject(const glm::vec3 &position, Geometry *geom, Shader *shader, GLuint texture, float yScale, float xScale, int health);
-            ~GameObject();
+            GameObject(const glm::vec3 &position, Geometry *geom, Shader *shader, const TextureRegion &texture, float yScale, float xScale, int health);
+            virtual ~GameObject();
             // Update the GameObject's state. Can be overriden in children
             virtual void Update(double delta_time);
 
-            // Renders the GameObject 
-            virtual void Render(glm::mat4 view_matrix, double current_time);
+            // Add what the GameObject draws to a snapshot, as a sprite
+            // Children that draw differently change the record they add
+            // The game sets the record's parent
+            virtual void Snapshot(RenderSnapshot &snapshot) const;
+
+            // Remember the current state as the previous simulation state
+            // Called at the start of every simulation step
+            void SaveState(void);
 
             // Getters
             inline glm::vec3 GetPosition(void) const { return position_; }
             inline float GetScale(void) const { return scale_; }
             inline float GetRotation(void) const { return angle_; }
             inline int GetHealth(void) const { return health_; }
+            inline Shader *GetShader(void) const { return shader_; }
+            inline Geometry *GetGeometry(void) const { return geometry_; }
+            inline GLuint GetTexture(void) const { return texture_; }
 
 
             // Get bearing direction (direction in which the game object
@@ -49,15 +77,56 @@ namespace game {
             glm::vec3 GetBottomLeft(void) const;
             glm::vec3 GetBottomRight(void) const;
 
-            inline void SetParticles(GameObject* particle) { particles_ = particle; }
+            // Handle of this object in the game's object store
+            inline const Handle& GetHandle(void) const { return handle_; }
+            inline void SetHandle(const Handle& handle) { handle_ = handle; }
+
+            // Particle system attached to this object, removed along with it
+            inline void SetParticles(const Handle& particles) { particles_ = particles; }
+            inline const Handle& GetParticles(void) const { return particles_; }
+
+            // Index of this object in the game's motion store, -1 if it is
+            // not in it; objects in the store are moved by the game, so
+            // Update() leaves their position alone
+            inline int GetMotionIndex(void) const { return motion_index_; }
+            inline void SetMotionIndex(int index) { motion_index_ = index; }
+
+            // Object this one moves relative to, null if it moves on its own
+            inline void SetParent(const Handle& parent) { parent_ = parent; }
+            inline const Handle& GetParent(void) const { return parent_; }
+
+            // Copy the transform of the parent
+            // The game looks up the parent handle and calls this before
+            // updating the object
+            void FollowParent(const GameObject& parent);
 
             inline bool GetInvincible(void) const { return invincible_; }
+            inline void SetInvincible(bool value) { invincible_ = value; }
             void PowerUp(void);
 
             inline bool GetAlive(void) const { return alive_; }
             void SetAlive(bool value);
 
-            inline Timer* GetDeath(void) const { return death_timer_; }
+            // A dead object stays in the game while it is dying, until its
+            // death timer expires
+            inline bool GetDying(void) const { return dying_; }
+            inline void SetDying(bool value) { dying_ = value; }
+
+            // An object outside the game's activation band sleeps: it is
+            // not updated, hit or drawn until the camera scrolls to it
+            inline bool GetAwake(void) const { return awake_; }
+            inline void SetAwake(bool value) { awake_ = value; }
+
+            // Seconds the object lives once added to the game, 0 for no limit
+            inline double GetLifespan(void) const { return lifespan_; }
+
+            // Set by the shot timer, cleared when the object shoots
+            inline bool GetShotReady(void) const { return shot_ready_; }
+            inline void SetShotReady(bool value) { shot_ready_ = value; }
+
+            // Timers running in the game's timer wheel for this object
+            inline const Handle& GetTimer(ObjectTimer kind) const { return timers_[kind]; }
+            inline void SetTimer(ObjectTimer kind, const Handle& timer) { timers_[kind] = timer; }
 
             // returns true if thing dies taking this damage
             bool TakeDamage(int value);
@@ -67,10 +136,13 @@ namespace game {
             inline void SetScale(float scale) { scale_ = scale; }
             void SetRotation(float angle);
             void SetType(ObjectType tp) { type_ = tp; }
-            inline void SetTexture(GLuint texture) { texture_ = texture; }
+            inline void SetTexture(const TextureRegion& texture) { texture_ = texture.texture; uv_rect_ = texture.uv_rect; }
+            // Part of the texture drawn: offset (xy) and size (zw)
+            // A size above 1 repeats the texture
+            inline void SetUVRect(const glm::vec4& uv_rect) { uv_rect_ = uv_rect; }
             // Velocity
             glm::vec3 GetVelocity(void) const { return velocity_; }
-            void SetVelocity(glm::vec3& vel) { velocity_ = vel; }
+            void SetVelocity(const glm::vec3& vel) { velocity_ = vel; }
 
         protected:
             // Object's Transform Variables
@@ -81,14 +153,28 @@ namespace game {
             float xScale_;
             glm::vec3 velocity_;
 
-            bool invincible_;
-            Timer* powerup_timer_;
+            // Previous simulation state, drawn blended with the current one
+            bool has_previous_;
+            glm::vec3 previous_position_;
+            float previous_angle_;
 
-            Timer* death_timer_;
+            bool invincible_;
 
             bool alive_;
+            bool dying_;
+            bool awake_;
+            double lifespan_;
+            bool shot_ready_;
+            Handle timers_[NumObjectTimers];
+
+            Handle handle_;
+            Handle particles_;
+            int motion_index_;
 
-            GameObject* particles_;
+            // Parent object and its last known transform
+            Handle parent_;
+            glm::vec3 parent_position_;
+            float parent_angle_;
 
             int health_;
 
@@ -100,6 +186,7 @@ namespace game {
 
             // Object's texture reference
             GLuint texture_;
+            glm::vec4 uv_rect_;
 
             // Object type
             ObjectType type_;
@@ -0,0 +1,35 @@
+#include "geometry.h"
+#include "render_state.h"
+
+namespace game {
+
+Geometry::~Geometry()
+{
+    for (int i = 0; i < vertex_arrays_.size(); i++) {
+        glDeleteVertexArrays(1, &vertex_arrays_[i].vao);
+    }
+}
+
+
+void Geometry::BindVertexArray(GLuint shader_program)
+{
+    // A geometry is used by one or two programs, so a search is enough
+    for (int i = 0; i < vertex_arrays_.size(); i++) {
+        if (vertex_arrays_[i].shader_program == shader_program) {
+            RenderState::BindVertexArray(vertex_arrays_[i].vao);
+            return;
+        }
+    }
+
+    // The vertex array remembers the buffers and attributes set up here
+    VertexArray vertex_array;
+    vertex_array.shader_program = shader_program;
+    glGenVertexArrays(1, &vertex_array.vao);
+    RenderState::BindVertexArray(vertex_array.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
+    SetAttributes(shader_program);
+    vertex_arrays_.push_back(vertex_array);
+}
+
+} // namespace game
@@ -1,6 +1,7 @@
 #ifndef GEOMETRY_H_
 #define GEOMETRY_H_
 
+#include <vector>
 #define GLEW_STATIC
 #include <GL/glew.h>
 
@@ -12,22 +13,39 @@ namespace game {
         public:
             // Constructor and destructor
             Geometry(void) {};
+            virtual ~Geometry();
 
             // Create the geometry (called once)
             virtual void CreateGeometry(void) {};
 
             // Use the geometry
-            virtual void SetGeometry(GLuint shader_program) {};
+            virtual void SetGeometry(GLuint /*shader_program*/) {};
 
             // Getter
             int GetSize(void) const { return size_; }
 
         protected:
+            // Bind the vertex array object that feeds the buffers to a shader
+            // program, creating it the first time the program is used
+            void BindVertexArray(GLuint shader_program);
+
+            // Point the attributes of a shader program at the buffers
+            // Called once per program, with its vertex array bound
+            virtual void SetAttributes(GLuint /*shader_program*/) {};
+
             // Geometry buffers
             GLuint vbo_;
             GLuint ebo_;
             int size_;
 
+        private:
+            // Vertex array object of each shader program using the geometry
+            struct VertexArray {
+                GLuint shader_program;
+                GLuint vao;
+            };
+            std::vector<VertexArray> vertex_arrays_;
+
     }; // class Geometry
 } // namespace game
 
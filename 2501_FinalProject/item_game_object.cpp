@@ -4,7 +4,7 @@
 
 namespace game {
 
-	ItemGameObject::ItemGameObject(const glm::vec3 &position, Geometry *geom, Shader *shader, GLuint texture, float yScale, float xScale, int health)
+	ItemGameObject::ItemGameObject(const glm::vec3 &position, Geometry *geom, Shader *shader, const TextureRegion &texture, float yScale, float xScale, int health)
 	: GameObject(position, geom, shader, texture, yScale, xScale, health) {
 
 	current_time_ = 0.0;
@@ -10,7 +10,7 @@ namespace game {
     class ItemGameObject : public GameObject {
 
         public:
-            ItemGameObject(const glm::vec3 &position, Geometry *geom, Shader *shader, GLuint texture, float yScale, float xScale, int health);
+            ItemGameObject(const glm::vec3 &position, Geometry *geom, Shader *shader, const TextureRegion &texture, float yScale, float xScale, int health);
 
             // Update function for moving the player object around
             void Update(double delta_time) override;
@@ -0,0 +1,157 @@
+#include <algorithm>
+
+#include "job_system.h"
+
+namespace game {
+
+JobSystem::JobSystem(void)
+{
+    num_threads_ = 1;
+    runs_ = nullptr;
+    function_ = nullptr;
+    body_ = nullptr;
+    count_ = 0;
+    grain_ = 1;
+    loop_number_ = 0;
+    quit_ = false;
+    busy_workers_ = 0;
+}
+
+
+JobSystem::~JobSystem()
+{
+    Stop();
+}
+
+
+void JobSystem::Start(int num_threads)
+{
+    Stop();
+    if (num_threads <= 0) num_threads = (int)std::thread::hardware_concurrency();
+    num_threads_ = std::max(num_threads, 1);
+
+    runs_ = new ChunkRun[num_threads_];
+    for (int thread = 0; thread < num_threads_; thread++) {
+        runs_[thread].chunks = 0;
+    }
+    loop_number_ = 0;
+    for (int thread = 1; thread < num_threads_; thread++) {
+        workers_.push_back(std::thread(&JobSystem::WorkerMain, this, thread));
+    }
+}
+
+
+void JobSystem::Stop(void)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        quit_ = true;
+    }
+    wake_.notify_all();
+    for (int i = 0; i < workers_.size(); i++) {
+        workers_[i].join();
+    }
+    workers_.clear();
+    quit_ = false;
+
+    delete[] runs_;
+    runs_ = nullptr;
+    num_threads_ = 1;
+}
+
+
+void JobSystem::Run(int count, int grain, ChunkFunction function, const void *body)
+{
+    unsigned long long num_chunks = (count + (unsigned long long)grain - 1) / grain;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        function_ = function;
+        body_ = body;
+        count_ = count;
+        grain_ = grain;
+        for (int thread = 0; thread < num_threads_; thread++) {
+            unsigned int first = (unsigned int)(num_chunks * thread / num_threads_);
+            unsigned int last = (unsigned int)(num_chunks * (thread + 1) / num_threads_);
+            runs_[thread].chunks = Pack(first, last);
+        }
+        busy_workers_ = num_threads_ - 1;
+        loop_number_++;
+    }
+    wake_.notify_all();
+
+    Work(0);
+
+    // The loop is over once every worker has run out of chunks, so none
+    // of them is left looking at it when the next one starts
+    while (busy_workers_.load() > 0) {
+        std::this_thread::yield();
+    }
+}
+
+
+void JobSystem::Work(int thread)
+{
+    unsigned int chunk;
+    while (TakeChunk(thread, chunk) || StealChunks(thread, chunk)) {
+        int begin = (int)chunk * grain_;
+        int end = std::min(count_, begin + grain_);
+        function_(body_, begin, end, thread);
+    }
+}
+
+
+bool JobSystem::TakeChunk(int thread, unsigned int &chunk)
+{
+    unsigned long long value = runs_[thread].chunks.load();
+    while (true) {
+        unsigned int first = (unsigned int)(value >> 32);
+        unsigned int last = (unsigned int)value;
+        if (first >= last) return false;
+        if (runs_[thread].chunks.compare_exchange_weak(value, Pack(first + 1, last))) {
+            chunk = first;
+            return true;
+        }
+    }
+}
+
+
+bool JobSystem::StealChunks(int thread, unsigned int &chunk)
+{
+    for (int offset = 1; offset < num_threads_; offset++) {
+        ChunkRun &victim = runs_[(thread + offset) % num_threads_];
+        unsigned long long value = victim.chunks.load();
+        while (true) {
+            unsigned int first = (unsigned int)(value >> 32);
+            unsigned int last = (unsigned int)value;
+            if (first >= last) break;
+            unsigned int middle = last - (last - first + 1) / 2;
+            if (victim.chunks.compare_exchange_weak(value, Pack(first, middle))) {
+                // Run the first stolen chunk now and keep the rest
+                // This thread's run is empty, so thieves leave it alone
+                // and a plain store is enough
+                chunk = middle;
+                runs_[thread].chunks = Pack(middle + 1, last);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+
+void JobSystem::WorkerMain(int thread)
+{
+    unsigned long seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&]() { return quit_ || loop_number_ != seen; });
+            if (quit_) return;
+            seen = loop_number_;
+        }
+        Work(thread);
+        busy_workers_--;
+    }
+}
+
+} // namespace game
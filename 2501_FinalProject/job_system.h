@@ -0,0 +1,101 @@
+#ifndef JOB_SYSTEM_H_
+#define JOB_SYSTEM_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace game {
+
+    // Worker threads that share loops over ranges of indices
+    // A loop is cut into chunks, and each thread starts with an equal run
+    // of consecutive chunks. It takes chunks from the front of its run, and
+    // when that is empty steals half of what is left at the back of another
+    // thread's run, so threads that finish early help the others
+    // The thread calling ParallelFor() works too, as thread 0
+    class JobSystem {
+
+        public:
+            // Only the calling thread until Start()
+            JobSystem(void);
+            ~JobSystem();
+
+            // Use num_threads threads, the calling one included, or one per
+            // core if num_threads is 0
+            void Start(int num_threads);
+
+            inline int GetNumThreads(void) const { return num_threads_; }
+
+            // Call body(begin, end, thread) on chunks of at most grain
+            // indices covering [0, count), and return when all are done
+            // The chunks run in no particular order; no two run on the same
+            // thread at once, so thread can index per-thread data
+            // Loops of up to grain indices run on the caller alone
+            template <typename Body>
+            void ParallelFor(int count, int grain, const Body &body) {
+                if (count <= 0) return;
+                if (num_threads_ == 1 || count <= grain) {
+                    body(0, count, 0);
+                    return;
+                }
+                Run(count, grain, &CallBody<Body>, &body);
+            }
+
+        private:
+            typedef void (*ChunkFunction)(const void *body, int begin, int end, int thread);
+
+            template <typename Body>
+            static void CallBody(const void *body, int begin, int end, int thread) {
+                (*static_cast<const Body*>(body))(begin, end, thread);
+            }
+
+            // Chunks [first, last) of a thread's run, packed in one word so
+            // the owner and thieves can change them with one compare-exchange
+            // Each run has a cache line of its own
+            struct alignas(64) ChunkRun {
+                std::atomic<unsigned long long> chunks;
+            };
+
+            inline static unsigned long long Pack(unsigned int first, unsigned int last) {
+                return ((unsigned long long)first << 32) | last;
+            }
+
+            // Split a loop among the threads and wait for it
+            void Run(int count, int grain, ChunkFunction function, const void *body);
+
+            // Run chunks of the current loop until none are left to take
+            void Work(int thread);
+            bool TakeChunk(int thread, unsigned int &chunk);
+            bool StealChunks(int thread, unsigned int &chunk);
+
+            // What the workers run, waiting between loops
+            void WorkerMain(int thread);
+
+            // Stop and join the workers
+            void Stop(void);
+
+            int num_threads_;
+            std::vector<std::thread> workers_;
+            ChunkRun *runs_;
+
+            // The current loop
+            ChunkFunction function_;
+            const void *body_;
+            int count_;
+            int grain_;
+
+            // Workers wait for a new loop number, and the caller for all of
+            // them to be done with it
+            std::mutex mutex_;
+            std::condition_variable wake_;
+            unsigned long loop_number_;
+            bool quit_;
+            std::atomic<int> busy_workers_;
+
+    }; // class JobSystem
+
+} // namespace game
+
+#endif // JOB_SYSTEM_H_
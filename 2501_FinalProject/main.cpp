@@ -8,6 +8,8 @@
 
 #include <iostream>
 #include <exception>
+#include <string>
+#include <cstdlib>
 #include "game.h"
 
 // Macro for printing exceptions
@@ -15,10 +17,35 @@
     std::cerr << exception_object.what() << std::endl
 
 // Main function that builds and runs the game
-int main(void){
+// Run with --headless [seconds] [time step] [wave file] to simulate the game without a window,
+// or with --no-render-thread to draw frames on the main thread, between simulation steps
+int main(int argc, char *argv[]){
     game::Game the_game;
 
+    // Default headless run: the whole game, at 60 ticks per second
+    bool headless = false;
+    double duration = 200.0;
+    double time_step = 1.0 / 60.0;
+    if (argc > 1 && std::string(argv[1]) == "--headless") {
+        headless = true;
+        if (argc > 2) duration = std::atof(argv[2]);
+        if (argc > 3) time_step = std::atof(argv[3]);
+        if (argc > 4) the_game.SetWaveFile(argv[4]);
+    }
+    else if (argc > 1 && std::string(argv[1]) == "--no-render-thread") {
+        the_game.SetRenderThread(false);
+    }
+
     try {
+        if (headless) {
+            // Initialize the simulation only
+            the_game.InitHeadless();
+            the_game.Setup();
+            // Simulate as fast as possible
+            the_game.RunHeadless(duration, time_step);
+            return 0;
+        }
+
         // Initialize graphics libraries and main window
         the_game.Init();
         // Setup the game (game world, game objects, etc.)
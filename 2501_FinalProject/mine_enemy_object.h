@@ -9,7 +9,7 @@ namespace game {
     class MineEnemyObject : public GameObject {
 
         public:
-            MineEnemyObject(const glm::vec3 &position, Geometry *geom, Shader *shader, GLuint texture, float yScale, float xScale, int health, glm::vec3 orbit);
+            MineEnemyObject(const glm::vec3 &position, Geometry *geom, Shader *shader, const TextureRegion &texture, float yScale, float xScale, int health, glm::vec3 orbit);
 
             // Update function for moving the player object around
             void Update(double delta_time) override;
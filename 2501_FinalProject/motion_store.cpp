@@ -0,0 +1,107 @@
+#include "motion_store.h"
+
+#if defined(MOTION_STORE_AVX)
+#include <immintrin.h>
+#elif defined(MOTION_STORE_SSE)
+#include <xmmintrin.h>
+#endif
+
+namespace game {
+
+int MotionStore::Add(GameObject *owner, const glm::vec3 &position, const glm::vec3 &velocity)
+{
+    x_.push_back(position.x);
+    y_.push_back(position.y);
+    z_.push_back(position.z);
+    vx_.push_back(velocity.x);
+    vy_.push_back(velocity.y);
+    owners_.push_back(owner);
+    return (int)owners_.size() - 1;
+}
+
+
+void MotionStore::Reserve(int count)
+{
+    x_.reserve(count);
+    y_.reserve(count);
+    z_.reserve(count);
+    vx_.reserve(count);
+    vy_.reserve(count);
+    owners_.reserve(count);
+}
+
+
+GameObject *MotionStore::Remove(int index)
+{
+    int last = (int)owners_.size() - 1;
+    if (index != last) {
+        x_[index] = x_[last];
+        y_[index] = y_[last];
+        z_[index] = z_[last];
+        vx_[index] = vx_[last];
+        vy_[index] = vy_[last];
+        owners_[index] = owners_[last];
+    }
+    x_.pop_back();
+    y_.pop_back();
+    z_.pop_back();
+    vx_.pop_back();
+    vy_.pop_back();
+    owners_.pop_back();
+
+    if (index == last) return nullptr;
+    return owners_[index];
+}
+
+
+void MotionStore::Clear(void)
+{
+    x_.clear();
+    y_.clear();
+    z_.clear();
+    vx_.clear();
+    vy_.clear();
+    owners_.clear();
+}
+
+
+void MotionStore::Integrate(float delta_time, int count)
+{
+    if (count > Size()) count = Size();
+    if (count <= 0) return;
+    IntegrateVector(x_.data(), vx_.data(), count, delta_time);
+    IntegrateVector(y_.data(), vy_.data(), count, delta_time);
+}
+
+
+void IntegrateScalar(float *p, const float *v, int count, float delta_time)
+{
+    for (int i = 0; i < count; i++) {
+        p[i] += v[i] * delta_time;
+    }
+}
+
+
+void IntegrateVector(float *p, const float *v, int count, float delta_time)
+{
+    int i = 0;
+#if defined(MOTION_STORE_AVX)
+    __m256 dt8 = _mm256_set1_ps(delta_time);
+    for (; i + 8 <= count; i += 8) {
+        __m256 pos = _mm256_loadu_ps(p + i);
+        __m256 vel = _mm256_loadu_ps(v + i);
+        _mm256_storeu_ps(p + i, _mm256_add_ps(pos, _mm256_mul_ps(vel, dt8)));
+    }
+#elif defined(MOTION_STORE_SSE)
+    __m128 dt4 = _mm_set1_ps(delta_time);
+    for (; i + 4 <= count; i += 4) {
+        __m128 pos = _mm_loadu_ps(p + i);
+        __m128 vel = _mm_loadu_ps(v + i);
+        _mm_storeu_ps(p + i, _mm_add_ps(pos, _mm_mul_ps(vel, dt4)));
+    }
+#endif
+    // Values left over after the last full vector
+    IntegrateScalar(p + i, v + i, count - i, delta_time);
+}
+
+} // namespace game
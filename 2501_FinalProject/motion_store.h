@@ -0,0 +1,69 @@
+#ifndef MOTION_STORE_H_
+#define MOTION_STORE_H_
+
+#include <vector>
+#include <glm/glm.hpp>
+
+// Pick the widest vector instructions the compiler targets
+// Define MOTION_STORE_SCALAR to force the plain C++ loop
+#if !defined(MOTION_STORE_SCALAR)
+#if defined(__AVX__)
+#define MOTION_STORE_AVX
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define MOTION_STORE_SSE
+#endif
+#endif
+
+namespace game {
+
+    class GameObject;
+
+    // Positions and velocities of the objects that move in a straight line
+    // (bullets, items, HUD text, background), stored as one array per
+    // coordinate so a whole step is integrated in one vectorized pass
+    // Movement is in the xy plane: z is kept for drawing but not integrated
+    class MotionStore {
+
+        public:
+            MotionStore(void) {}
+
+            // Add an object, returns its index in the store
+            int Add(GameObject *owner, const glm::vec3 &position, const glm::vec3 &velocity);
+
+            // Remove the object at index by moving the last object into its
+            // place; returns the object now at index, or nullptr if none
+            GameObject *Remove(int index);
+
+            // Remove all objects
+            void Clear(void);
+
+            // Make room for count objects, so adding up to that many never
+            // reallocates
+            void Reserve(int count);
+
+            // Move the first count objects by their velocity over delta_time
+            // Objects are added at the end, so this skips the newest ones
+            void Integrate(float delta_time, int count);
+
+            inline int Size(void) const { return (int)owners_.size(); }
+            inline GameObject *GetOwner(int index) const { return owners_[index]; }
+            inline glm::vec3 GetPosition(int index) const { return glm::vec3(x_[index], y_[index], z_[index]); }
+
+        private:
+            std::vector<float> x_;
+            std::vector<float> y_;
+            std::vector<float> z_;
+            std::vector<float> vx_;
+            std::vector<float> vy_;
+            std::vector<GameObject *> owners_;
+
+    }; // class MotionStore
+
+    // Integration kernels, p[i] += v[i] * delta_time for count values
+    // The vectorized one falls back to the scalar one without SSE or AVX
+    void IntegrateScalar(float *p, const float *v, int count, float delta_time);
+    void IntegrateVector(float *p, const float *v, int count, float delta_time);
+
+} // namespace game
+
+#endif // MOTION_STORE_H_
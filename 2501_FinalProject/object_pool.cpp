@@ -0,0 +1,73 @@
+#include <new>
+
+#include "object_pool.h"
+
+namespace game {
+
+ObjectPool::ObjectPool(std::size_t block_size, int blocks_per_chunk)
+{
+    // Every block must be able to hold the free list link, and keep the
+    // alignment of the objects stored after it
+    std::size_t alignment = alignof(std::max_align_t);
+    if (block_size < sizeof(FreeBlock)) {
+        block_size = sizeof(FreeBlock);
+    }
+    block_size_ = (block_size + alignment - 1) / alignment * alignment;
+    blocks_per_chunk_ = blocks_per_chunk;
+    free_list_ = nullptr;
+    num_allocated_ = 0;
+}
+
+
+ObjectPool::~ObjectPool()
+{
+    for (int i = 0; i < chunks_.size(); i++) {
+        ::operator delete(chunks_[i]);
+    }
+}
+
+
+void *ObjectPool::Allocate(void)
+{
+    if (free_list_ == nullptr) {
+        Grow();
+    }
+    FreeBlock *block = free_list_;
+    free_list_ = block->next;
+    num_allocated_++;
+    return block;
+}
+
+
+void ObjectPool::Free(void *block)
+{
+    if (block == nullptr) return;
+    FreeBlock *free_block = static_cast<FreeBlock *>(block);
+    free_block->next = free_list_;
+    free_list_ = free_block;
+    num_allocated_--;
+}
+
+
+void ObjectPool::Reserve(int count)
+{
+    while (GetCapacity() < count) {
+        Grow();
+    }
+}
+
+
+void ObjectPool::Grow(void)
+{
+    char *chunk = static_cast<char *>(::operator new(block_size_ * blocks_per_chunk_));
+    chunks_.push_back(chunk);
+
+    // Link the blocks in address order, so the first allocations are adjacent
+    for (int i = blocks_per_chunk_ - 1; i >= 0; i--) {
+        FreeBlock *block = reinterpret_cast<FreeBlock *>(chunk + i * block_size_);
+        block->next = free_list_;
+        free_list_ = block;
+    }
+}
+
+} // namespace game
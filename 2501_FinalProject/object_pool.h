@@ -0,0 +1,55 @@
+#ifndef OBJECT_POOL_H_
+#define OBJECT_POOL_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace game {
+
+    // Allocator for many objects of one size
+    // Blocks are carved out of large chunks and recycled through a free
+    // list, so once the pool has grown to the peak number of live objects
+    // allocating and freeing never reach the heap
+    // Chunks are only returned to the heap when the pool is destroyed
+    class ObjectPool {
+
+        public:
+            // block_size is the size of one object, blocks_per_chunk how
+            // many objects the pool grows by when it runs out
+            ObjectPool(std::size_t block_size, int blocks_per_chunk);
+            ~ObjectPool();
+
+            // Get memory for one object
+            void *Allocate(void);
+
+            // Give back memory returned by Allocate()
+            void Free(void *block);
+
+            // Grow until count objects fit, so allocating that many never
+            // reaches the heap
+            void Reserve(int count);
+
+            // Objects currently allocated, and objects the pool can hold
+            inline int GetNumAllocated(void) const { return num_allocated_; }
+            inline int GetCapacity(void) const { return (int)chunks_.size() * blocks_per_chunk_; }
+
+        private:
+            // A free block holds the link to the next free block
+            struct FreeBlock {
+                FreeBlock *next;
+            };
+
+            // Allocate a new chunk and put its blocks on the free list
+            void Grow(void);
+
+            std::size_t block_size_;
+            int blocks_per_chunk_;
+            std::vector<char *> chunks_;
+            FreeBlock *free_list_;
+            int num_allocated_;
+
+    }; // class ObjectPool
+
+} // namespace game
+
+#endif // OBJECT_POOL_H_
@@ -7,14 +7,13 @@ in vec2 uv_interp;
 
 // Texture sampler
 uniform sampler2D onetex;
-uniform int explosion;
 
 void main()
 {
     // Sample texture
     vec4 color = texture2D(onetex, uv_interp);
-    if (explosion == 0) color.rgb = vec3(0.01, 0.05, 0.9) * color_interp.r;
-    if (explosion == 1) color.rgb = vec3(0.7, 0.4, 0.01) * color_interp.r;
+    // PARTICLE_COLOR is compiled in by ParticlePool
+    color.rgb = PARTICLE_COLOR * color_interp.r;
     //vec4 color = vec4(0.8, 0.4, 0.01, 1.0);
 
     // Assign color to fragment
@@ -0,0 +1,234 @@
+#include <cstddef>
+#include <sstream>
+
+#include "particle_pool.h"
+#include "render_state.h"
+
+namespace game {
+
+// Vertices per particle, two triangles
+const int particle_vertices_g = 6;
+
+// From particle_vertex_shader.glsl: particles are unit squares, moving
+// at most 2 * 0.8 times the effect's speed
+const float particle_half_diagonal_g = 0.70711f;
+const float particle_max_speed_g = 1.6f;
+
+
+// Point an attribute at the bound array buffer, skipping attributes the
+// shader compiler removed
+static void EnableAttribute(GLint location, GLint size, GLsizei stride, size_t offset)
+{
+    if (location < 0) return;
+    glVertexAttribPointer(location, size, GL_FLOAT, GL_FALSE, stride, (void *)offset);
+    glEnableVertexAttribArray(location);
+}
+
+
+// Float constant for a shader; always has a decimal point, since GLSL 1.30
+// doesn't turn integers into floats
+static std::string ShaderFloat(float value)
+{
+    std::ostringstream out;
+    out.precision(9);
+    out << std::showpoint << value;
+    return out.str();
+}
+
+
+ParticlePool::ParticlePool(void)
+{
+    // Don't do work in the constructor, leave it for the Init() function
+    view_matrix_ = glm::mat4(1.0f);
+    instancing_ = false;
+    num_emitters_ = 0;
+    num_draws_ = 0;
+    emitter_vbo_ = 0;
+}
+
+
+ParticlePool::~ParticlePool()
+{
+    for (int i = 0; i < effects_.size(); i++) {
+        delete effects_[i].shader;
+    }
+}
+
+
+void ParticlePool::Init(const std::string &vertex_path, const std::string &fragment_path)
+{
+    vertex_path_ = vertex_path;
+    fragment_path_ = fragment_path;
+
+    // Instanced attributes are core in OpenGL 3.3
+    instancing_ = GLEW_VERSION_3_3 ? true : false;
+
+    glGenBuffers(1, &emitter_vbo_);
+}
+
+
+int ParticlePool::AddEffect(const ParticleEffect &params)
+{
+    // The effect's parameters become constants of its shader variant
+    std::string defines;
+    defines += "#define PARTICLE_DIRECTION " + ShaderFloat(params.direction) + "\n";
+    defines += "#define PARTICLE_SPREAD " + ShaderFloat(params.spread) + "\n";
+    defines += "#define PARTICLE_SPEED " + ShaderFloat(params.speed) + "\n";
+    if (params.cycle > 0.0f) {
+        defines += "#define PARTICLE_CYCLE " + ShaderFloat(params.cycle) + "\n";
+    }
+    defines += "#define PARTICLE_COLOR vec3(" + ShaderFloat(params.color.r) + ", " + ShaderFloat(params.color.g) + ", " + ShaderFloat(params.color.b) + ")\n";
+
+    Effect effect;
+    effect.params = params;
+    effect.shader = new Shader();
+    effect.shader->Init(vertex_path_.c_str(), fragment_path_.c_str(), defines);
+    effect.view_matrix_uniform = effect.shader->GetUniform("view_matrix");
+
+    GLuint program = effect.shader->GetShaderProgram();
+    effect.matrix_att = glGetAttribLocation(program, "emitter_matrix");
+    effect.position_att = glGetAttribLocation(program, "emitter_position");
+    effect.time_att = glGetAttribLocation(program, "emitter_time");
+
+    // The vertex array only holds the emitter attributes; particles are
+    // made in the shader from gl_VertexID
+    glGenVertexArrays(1, &effect.vertex_array);
+    RenderState::BindVertexArray(effect.vertex_array);
+
+    // Emitter attributes advance once per instance; without instancing they
+    // are set as constant attributes before each draw
+    if (instancing_) {
+        GLint atts[] = { effect.matrix_att, effect.position_att, effect.time_att };
+        for (int i = 0; i < 3; i++) {
+            if (atts[i] >= 0) glVertexAttribDivisor(atts[i], 1);
+        }
+    }
+
+    // Unbind, so buffers bound later don't end up in this vertex array
+    RenderState::BindVertexArray(0);
+
+    effects_.push_back(effect);
+    return (int)effects_.size() - 1;
+}
+
+
+void ParticlePool::Begin(const glm::mat4 &view_matrix)
+{
+    view_matrix_ = view_matrix;
+    for (int i = 0; i < groups_.size(); i++) {
+        groups_[i].emitters.clear();
+    }
+    num_emitters_ = 0;
+}
+
+
+void ParticlePool::Add(int effect, GLuint texture, const glm::mat4 &transformation, float time, int num_particles)
+{
+    if (num_particles < 0) num_particles = effects_[effect].params.num_particles;
+    if (num_particles == 0) return;
+
+    // Emitters only rotate, scale and move in the plane, so the upper 2x2
+    // block and the translation are the whole transformation
+    Emitter emitter;
+    emitter.matrix[0] = transformation[0][0];
+    emitter.matrix[1] = transformation[0][1];
+    emitter.matrix[2] = transformation[1][0];
+    emitter.matrix[3] = transformation[1][1];
+    emitter.position[0] = transformation[3][0];
+    emitter.position[1] = transformation[3][1];
+    emitter.position[2] = transformation[3][2];
+    emitter.time = time;
+
+    // There are only a few kinds of emitter, so a linear search is enough
+    int group = -1;
+    for (int i = 0; i < groups_.size(); i++) {
+        if (groups_[i].effect == effect && groups_[i].texture == texture && groups_[i].num_particles == num_particles) {
+            group = i;
+            break;
+        }
+    }
+    if (group < 0) {
+        Group new_group;
+        new_group.effect = effect;
+        new_group.texture = texture;
+        new_group.num_particles = num_particles;
+        groups_.push_back(new_group);
+        group = (int)groups_.size() - 1;
+    }
+    groups_[group].emitters.push_back(emitter);
+    num_emitters_++;
+}
+
+
+void ParticlePool::SetEmitterAttributes(const Effect &effect, size_t offset)
+{
+    EnableAttribute(effect.matrix_att, 4, sizeof(Emitter), offset + offsetof(Emitter, matrix));
+    EnableAttribute(effect.position_att, 3, sizeof(Emitter), offset + offsetof(Emitter, position));
+    EnableAttribute(effect.time_att, 1, sizeof(Emitter), offset + offsetof(Emitter, time));
+}
+
+
+float ParticlePool::GetReach(int effect, float time) const
+{
+    // Cycling particles start over before the end of the cycle
+    const ParticleEffect &params = effects_[effect].params;
+    float travel = (params.cycle > 0.0f) ? params.cycle : time;
+    return particle_half_diagonal_g + particle_max_speed_g * params.speed * travel;
+}
+
+
+void ParticlePool::Flush(void)
+{
+    num_draws_ = 0;
+    if (num_emitters_ == 0) return;
+
+    // Additive blending, particles don't hide each other
+    RenderState::SetDepthTest(false);
+    RenderState::SetBlend(true, GL_ONE, GL_ONE);
+
+    if (instancing_) {
+
+        // Upload all emitters at once, grouped by effect, texture and size
+        emitters_.clear();
+        for (int i = 0; i < groups_.size(); i++) {
+            emitters_.insert(emitters_.end(), groups_[i].emitters.begin(), groups_[i].emitters.end());
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, emitter_vbo_);
+        glBufferData(GL_ARRAY_BUFFER, emitters_.size() * sizeof(Emitter), emitters_.data(), GL_STREAM_DRAW);
+    }
+
+    size_t first = 0;
+    for (int i = 0; i < groups_.size(); i++) {
+        const Group &group = groups_[i];
+        int count = (int)group.emitters.size();
+        if (count == 0) continue;
+
+        const Effect &effect = effects_[group.effect];
+        effect.shader->Enable();
+        effect.shader->SetUniformMat4(effect.view_matrix_uniform, view_matrix_);
+        RenderState::BindVertexArray(effect.vertex_array);
+        RenderState::BindTexture(group.texture);
+        int num_vertices = group.num_particles * particle_vertices_g;
+
+        if (instancing_) {
+            // One instanced draw for the group
+            SetEmitterAttributes(effect, first * sizeof(Emitter));
+            glDrawArraysInstanced(GL_TRIANGLES, 0, num_vertices, count);
+            num_draws_++;
+        }
+        else {
+            // One draw per emitter, its parameters held as constant attributes
+            for (int j = 0; j < count; j++) {
+                const Emitter &emitter = group.emitters[j];
+                if (effect.matrix_att >= 0) glVertexAttrib4fv(effect.matrix_att, emitter.matrix);
+                if (effect.position_att >= 0) glVertexAttrib3fv(effect.position_att, emitter.position);
+                if (effect.time_att >= 0) glVertexAttrib1f(effect.time_att, emitter.time);
+                glDrawArrays(GL_TRIANGLES, 0, num_vertices);
+                num_draws_++;
+            }
+        }
+        first += count;
+    }
+}
+
+} // namespace game
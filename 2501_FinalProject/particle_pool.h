@@ -0,0 +1,123 @@
+#ifndef PARTICLE_POOL_H_
+#define PARTICLE_POOL_H_
+
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+#include "shader.h"
+
+namespace game {
+
+    // A kind of particle emitter
+    // The parameters are compiled into a shader program of their own, so
+    // the particle shader has no branches on the kind of emitter
+    struct ParticleEffect {
+        // Particles of an emitter that doesn't set its own number
+        int num_particles;
+        // Mean direction of the particles and largest angle away from it,
+        // in radians
+        float direction;
+        float spread;
+        float speed;
+        // Seconds before a particle starts over, 0 for particles that
+        // never come back
+        float cycle;
+        glm::vec3 color;
+    };
+
+    // Draws the particles of every particle system, one draw call per kind
+    // of emitter
+    // Particles have no vertex data: the shader makes each one from its
+    // vertex number, and reads the parameters of its emitter
+    // (transformation and time) per instance
+    // Without instancing (before OpenGL 3.3) there is one draw per emitter
+    class ParticlePool {
+
+        public:
+            ParticlePool(void);
+            ~ParticlePool();
+
+            // Set the shader source files, compiled once for every effect
+            void Init(const std::string &vertex_path, const std::string &fragment_path);
+
+            // Compile the shader variant of an effect and get its index
+            int AddEffect(const ParticleEffect &effect);
+
+            // Start a new frame of emitters
+            void Begin(const glm::mat4 &view_matrix);
+
+            // Add an emitter; time is the time since the emitter started and
+            // selects where its particles are along their paths
+            // A negative number of particles takes the effect's number
+            void Add(int effect, GLuint texture, const glm::mat4 &transformation, float time, int num_particles = -1);
+
+            // Furthest a particle of an effect can be from its emitter, in
+            // the emitter's units, at a time since the emitter started
+            float GetReach(int effect, float time) const;
+
+            // Draw all emitters added since Begin()
+            void Flush(void);
+
+            inline bool GetInstancing(void) const { return instancing_; }
+
+            // Emitters and draw calls of the last Flush()
+            inline int GetNumEmitters(void) const { return num_emitters_; }
+            inline int GetNumDraws(void) const { return num_draws_; }
+
+        private:
+            // Per-emitter data, read once per instance
+            struct Emitter {
+                // 2D rotation and scale (two columns) and translation
+                float matrix[4];
+                float position[3];
+                float time;
+            };
+
+            // Shader variant of an effect
+            // Attribute locations differ between variants, so each has its
+            // own vertex array
+            struct Effect {
+                ParticleEffect params;
+                Shader *shader;
+                UniformHandle view_matrix_uniform;
+                GLuint vertex_array;
+                GLint matrix_att;
+                GLint position_att;
+                GLint time_att;
+            };
+
+            // Emitters that share an effect, a texture and a number of
+            // particles
+            struct Group {
+                int effect;
+                GLuint texture;
+                int num_particles;
+                std::vector<Emitter> emitters;
+            };
+
+            // Point the emitter attributes of an effect at an offset in the
+            // bound buffer
+            void SetEmitterAttributes(const Effect &effect, size_t offset);
+
+            std::string vertex_path_;
+            std::string fragment_path_;
+            glm::mat4 view_matrix_;
+            bool instancing_;
+
+            std::vector<Effect> effects_;
+            std::vector<Group> groups_;
+            int num_emitters_;
+            int num_draws_;
+
+            // Emitters of the frame
+            GLuint emitter_vbo_;
+            std::vector<Emitter> emitters_;
+
+    }; // class ParticlePool
+
+} // namespace game
+
+#endif // PARTICLE_POOL_H_
@@ -2,70 +2,68 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "particle_system.h"
+#include "render_snapshot.h"
+#include "object_pool.h"
 #include <iostream>
 
 
 namespace game {
 
-ParticleSystem::ParticleSystem(const glm::vec3 &position, Geometry *geom, Shader *shader, GLuint texture, GameObject *parent, float yScale, float xScale, int health)
-	: GameObject(position, geom, shader, texture, yScale, xScale, health){
+ParticleSystem::ParticleSystem(const glm::vec3 &position, ParticlePool *pool, int effect, const TextureRegion &texture, const Handle &parent, float yScale, float xScale, int health)
+	: GameObject(position, nullptr, nullptr, texture, yScale, xScale, health){
 
     parent_ = parent;
     reset_timer_ = 0;
     type_ = PSystemObj;
+    pool_ = pool;
+    effect_ = effect;
+    num_particles_ = -1;
 }
 
 
-void ParticleSystem::Update(double delta_time) {
-    reset_timer_ += delta_time;
-    // Call the parent's update method to move the object in standard way, if desired
-    GameObject::Update(delta_time);
+// Pool shared by all particle systems
+static ObjectPool &ParticleSystemPool(void) {
+    static ObjectPool pool(sizeof(ParticleSystem), 64);
+    return pool;
 }
 
 
-void ParticleSystem::Render(glm::mat4 view_matrix, double current_time){
-
-    // Set up the shader
-    shader_->Enable();
-
-    // Set up the view matrix
-    shader_->SetUniformMat4("view_matrix", view_matrix);
-
-    // Setup the scaling matrix for the shader
-    glm::mat4 scaling_matrix = glm::scale(glm::mat4(1.0f), glm::vec3(scale_, scale_, 1.0));
+void *ParticleSystem::operator new(std::size_t size) {
+    if (size != sizeof(ParticleSystem)) return ::operator new(size);
+    return ParticleSystemPool().Allocate();
+}
 
-    // Setup the rotation matrix for the shader
-    glm::mat4 rotation_matrix = glm::rotate(glm::mat4(1.0f), angle_, glm::vec3(0.0, 0.0, 1.0));
 
-    // Set up the translation matrix for the shader
-    glm::mat4 translation_matrix = glm::translate(glm::mat4(1.0f), position_);
+void ParticleSystem::operator delete(void *block, std::size_t size) {
+    if (size != sizeof(ParticleSystem)) {
+        ::operator delete(block);
+        return;
+    }
+    ParticleSystemPool().Free(block);
+}
 
-    // Set up the parent transformation matrix
-    glm::mat4 parent_rotation_matrix = glm::rotate(glm::mat4(1.0f), parent_->GetRotation(), glm::vec3(0.0, 0.0, 1.0));
-    glm::mat4 parent_translation_matrix = glm::translate(glm::mat4(1.0f), parent_->GetPosition());
-    glm::mat4 parent_transformation_matrix = parent_translation_matrix * parent_rotation_matrix;
 
-    // Setup the transformation matrix for the shader
-    glm::mat4 transformation_matrix = parent_transformation_matrix * translation_matrix * rotation_matrix * scaling_matrix;
+void ParticleSystem::ReservePool(int count) {
+    ParticleSystemPool().Reserve(count);
+}
 
-    // Set the transformation matrix in the shader
-    shader_->SetUniformMat4("transformation_matrix", transformation_matrix);
 
-    // Set the time in the shader
-    shader_->SetUniform1f("time", reset_timer_);
-    if (type_ == PSystemExplosionObj) {
-        shader_->SetUniform1i("explosion", 1);
-    }
-    else shader_->SetUniform1i("explosion", 0);
+void ParticleSystem::Update(double delta_time) {
+    reset_timer_ += delta_time;
+    // Call the parent's update method to move the object in standard way, if desired
+    GameObject::Update(delta_time);
+}
 
-    // Set up the geometry
-    geometry_->SetGeometry(shader_->GetShaderProgram());
 
-    // Bind the particle texture
-    glBindTexture(GL_TEXTURE_2D, texture_);
+void ParticleSystem::Snapshot(RenderSnapshot &snapshot) const {
 
-    // Draw the entity
-    glDrawElements(GL_TRIANGLES, geometry_->GetSize(), GL_UNSIGNED_INT, 0);
+    GameObject::Snapshot(snapshot);
+    DrawRecord &record = snapshot.records.back();
+    record.kind = ParticleDraw;
+    record.pool = pool_;
+    record.effect = effect_;
+    record.reset_timer = reset_timer_;
+    record.num_particles = num_particles_;
 }
 
 } // namespace game
@@ -1,7 +1,10 @@
 #ifndef PARTICLE_SYSTEM_H_
 #define PARTICLE_SYSTEM_H_
 
+#include <cstddef>
+
 #include "game_object.h"
+#include "particle_pool.h"
 
 namespace game {
 
@@ -9,15 +12,35 @@ namespace game {
     class ParticleSystem : public GameObject {
 
         public:
-            ParticleSystem(const glm::vec3 &position, Geometry *geom, Shader *shader, GLuint texture, GameObject *parent, float yScale, float xScale, int health);
+            ParticleSystem(const glm::vec3 &position, ParticlePool *pool, int effect, const TextureRegion &texture, const Handle &parent, float yScale, float xScale, int health);
 
             void Update(double delta_time) override;
 
-            void Render(glm::mat4 view_matrix, double current_time);
+            // The particles are drawn by the pool, at the system's current
+            // time and position in its parent's frame
+            void Snapshot(RenderSnapshot &snapshot) const override;
+
+            // Number of particles the system emits, negative for the number
+            // of its effect
+            inline int GetNumParticles(void) const { return num_particles_; }
+            inline void SetNumParticles(int num_particles) { num_particles_ = num_particles; }
+
+            // Particle systems are allocated from a pool, since one is made
+            // for every torpedo and every explosion
+            static void *operator new(std::size_t size);
+            static void operator delete(void *block, std::size_t size);
+
+            // Make room in the pool for count particle systems
+            static void ReservePool(int count);
 
         private:
-            GameObject *parent_;
             double reset_timer_;
+            int num_particles_;
+
+            // Pool that draws the particles of all systems, and the index of
+            // the effect in the pool
+            ParticlePool *pool_;
+            int effect_;
 
     }; // class ParticleSystem
 
@@ -1,101 +1,76 @@
 // Source code of vertex shader for particle system
 #version 130
 
-// Vertex buffer
-in vec2 vertex; // Vertex coordinates
-in vec2 dir; // Velocity
-in float t; // Phase
-in vec2 uv; // Texture coordinates
+// Particles have no vertex buffer: six vertices per particle, numbered by
+// gl_VertexID, and the direction and phase come from a hash of the number
+
+// The kind of emitter is compiled in by ParticlePool:
+// PARTICLE_DIRECTION, PARTICLE_SPREAD: mean direction and largest angle
+// away from it
+// PARTICLE_SPEED: speed adjustment constant
+// PARTICLE_CYCLE: duration of cycle in seconds, undefined for particles
+// that never come back
+
+// Emitter, one per instance
+in vec4 emitter_matrix; // Rotation and scale, two columns
+in vec3 emitter_position; // Translation
+in float emitter_time; // Timer
 
 // Uniform (global) buffer
-uniform mat4 transformation_matrix;
 uniform mat4 view_matrix;
-uniform float time; // Timer
-uniform int explosion; // Tells whether this is an explosion or not
 
 // Attributes forwarded to the fragment shader
 out vec4 color_interp;
 out vec2 uv_interp;
 
-void main()
-{
-    if (explosion == 1) {
-        float cycle = 0.0;
-        float speed = 12.0;
-        vec4 pos; // Vertex position
-        float gravity = 1.0; // Gravity in this world
-        float acttime; // Cyclic time
-
-        // Add phase to the time and cycle it
-        acttime = mod(time + t*cycle, cycle);
-
-        // Move particle along given direction
-        //pos = vec4(vertex.x + acttime*speed*dir.x , vertex.y + acttime*speed*dir.y , 0.0, 1.0);
-        pos = vec4(vertex + 2.0*acttime*speed*dir, 0.0, 1.0);
-
-        // Debug initial particle setup
-        //pos = vec4(vertex + dir, 0.0, 1.0);
-
-        // Add wobble effect
-        //pos = vec4(vertex.x + cos(acttime)*speed*dir.x , vertex.y + sin(acttime)*speed*dir.y , 0.0, 1.0);
-
-        // Add gravity
-        //pos = vec4(vertex.x+dir.x*acttime*speed , vertex.y+dir.y*acttime*speed + 0.5*gravity*acttime*acttime, 0.0, 1.0);
-
-        // No motion, for debug
-        //pos = vec4(vertex.x, vertex.y, 0.0, 1.0);
-
-        // Transform vertex position
-        gl_Position = view_matrix*transformation_matrix*pos;
-    
-        //gl_Position.y -= 0.1*gravity*acttime*acttime;
-    
-        // Set color
-        //color_interp = vec4(0.5+0.5*cos(4*acttime),0.5*sin(4*acttime)+0.5,0.5, 1.0);
-        //color_interp = vec4(t, 0.0, 0.0, 1.0);
-        color_interp = vec4(0.1, 1.0, 1.0, 1.0);
+// Corners of the two triangles of a particle
+const vec2 corners[6] = vec2[6](vec2(-0.5, 0.5), vec2(0.5, 0.5), vec2(0.5, -0.5),
+                                vec2(0.5, -0.5), vec2(-0.5, -0.5), vec2(-0.5, 0.5));
 
-        // Transfer texture coordinates
-        uv_interp = uv;
-    }
-    else {
-        vec4 pos; // Vertex position
-        float cycle = 5.0; // Duration of cycle in seconds
-        float speed = 1.0; // Speed adjustment constant
-        float gravity = 1.0; // Gravity in this world
-        float acttime; // Cyclic time
-
-        // Add phase to the time and cycle it
-        acttime = mod(time + t*cycle, cycle);
-
-        // Move particle along given direction
-        //pos = vec4(vertex.x + acttime*speed*dir.x , vertex.y + acttime*speed*dir.y , 0.0, 1.0);
-        pos = vec4(vertex + 2.0*acttime*speed*dir, 0.0, 1.0);
-
-        // Debug initial particle setup
-        //pos = vec4(vertex + dir, 0.0, 1.0);
-
-        // Add wobble effect
-        //pos = vec4(vertex.x + cos(acttime)*speed*dir.x , vertex.y + sin(acttime)*speed*dir.y , 0.0, 1.0);
-
-        // Add gravity
-        //pos = vec4(vertex.x+dir.x*acttime*speed , vertex.y+dir.y*acttime*speed + 0.5*gravity*acttime*acttime, 0.0, 1.0);
-
-        // No motion, for debug
-        //pos = vec4(vertex.x, vertex.y, 0.0, 1.0);
-
-        // Transform vertex position
-        gl_Position = view_matrix*transformation_matrix*pos;
-    
-        //gl_Position.y -= 0.1*gravity*acttime*acttime;
-    
-        // Set color
-        //color_interp = vec4(0.5+0.5*cos(4*acttime),0.5*sin(4*acttime)+0.5,0.5, 1.0);
-        //color_interp = vec4(t, 0.0, 0.0, 1.0);
-        color_interp = vec4(0.1, 1.0, 1.0, 1.0);
+// Random number in [0, 1) from an integer
+float Random(uint x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return float(x >> 8) / 16777216.0;
+}
 
-        // Transfer texture coordinates
-        uv_interp = uv;
-    }
-    
+void main()
+{
+    uint particle = uint(gl_VertexID / 6);
+    vec2 vertex = corners[gl_VertexID % 6];
+    vec2 uv = vec2(vertex.x + 0.5, 0.5 - vertex.y);
+
+    // Three random values per particle
+    float theta = (2.0*Random(particle*3u) - 1.0)*PARTICLE_SPREAD + PARTICLE_DIRECTION;
+    float r = 0.8*Random(particle*3u + 1u);
+    float t = Random(particle*3u + 2u); // Phase
+    vec2 dir = vec2(sin(theta)*r, cos(theta)*r); // Velocity
+
+    mat4 transformation_matrix = mat4(vec4(emitter_matrix.xy, 0.0, 0.0),
+                                      vec4(emitter_matrix.zw, 0.0, 0.0),
+                                      vec4(0.0, 0.0, 1.0, 0.0),
+                                      vec4(emitter_position, 1.0));
+
+    // Add phase to the time and cycle it
+#ifdef PARTICLE_CYCLE
+    float acttime = mod(emitter_time + t*PARTICLE_CYCLE, PARTICLE_CYCLE);
+#else
+    float acttime = emitter_time;
+#endif
+
+    // Move particle along given direction
+    vec4 pos = vec4(vertex + 2.0*acttime*PARTICLE_SPEED*dir, 0.0, 1.0);
+
+    // Transform vertex position
+    gl_Position = view_matrix*transformation_matrix*pos;
+
+    // Set color
+    color_interp = vec4(0.1, 1.0, 1.0, 1.0);
+
+    // Transfer texture coordinates
+    uv_interp = uv;
 }
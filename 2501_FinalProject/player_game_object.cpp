@@ -7,7 +7,7 @@ namespace game {
 	It overrides GameObject's update method, so that you can check for input to change the velocity of the player
 */
 
-PlayerGameObject::PlayerGameObject(const glm::vec3 &position, Geometry *geom, Shader *shader, GLuint texture, float yScale, float xScale, int health, int maxHealth)
+PlayerGameObject::PlayerGameObject(const glm::vec3 &position, Geometry *geom, Shader *shader, const TextureRegion &texture, float yScale, float xScale, int health, int maxHealth)
 	: GameObject(position, geom, shader, texture, yScale, xScale, health) {
 	max_health_ = maxHealth;
 }
@@ -19,13 +19,13 @@ void PlayerGameObject::Update(double delta_time, glm::vec3 camera) {
 	if ((position_.x >= camera.x - 5.2f) && (position_.x <= camera.x + 5.2f) && (position_.y >= camera.y - 2.7f) && (position_.y <= camera.y + 3.0f)) {
 		this->position_ += (float)delta_time * this->velocity_;
 	}
-	if (position_.x <= camera.x - 5.2f) this->position_ += glm::vec3(0.02f, 0.0f, 0.0f);
-	if (position_.x >= camera.x + 5.2f) this->position_ += glm::vec3(-0.02f, 0.0f, 0.0f);
-	if (position_.y <= camera.y - 2.7f) this->position_ += glm::vec3(0.0f, 0.01f, 0.0f);
+	// Push back inside the camera edges at a fixed rate (0.02 and 0.01 units per step at 60 Hz)
+	if (position_.x <= camera.x - 5.2f) this->position_ += (float)delta_time * glm::vec3(1.2f, 0.0f, 0.0f);
+	if (position_.x >= camera.x + 5.2f) this->position_ += (float)delta_time * glm::vec3(-1.2f, 0.0f, 0.0f);
+	if (position_.y <= camera.y - 2.7f) this->position_ += (float)delta_time * glm::vec3(0.0f, 0.6f, 0.0f);
 	//if (position_.y < camera.y + 3.0f) this->position_ += (float)delta_time * this->velocity_;
 
 	
-	if (powerup_timer_->Finished()) invincible_ = false;
 	// Call the parent's update method to move the object in standard way, if desired
 	if (health_ <= 0) alive_ = false;
 	//GameObject::Update(delta_time);
@@ -8,7 +8,7 @@ namespace game {
     class PlayerGameObject : public GameObject {
 
         public:
-            PlayerGameObject(const glm::vec3 &position, Geometry *geom, Shader *shader, GLuint texture, float yScale, float xScale, int health, int maxHealth);
+            PlayerGameObject(const glm::vec3 &position, Geometry *geom, Shader *shader, const TextureRegion &texture, float yScale, float xScale, int health, int maxHealth);
 
             // Update function for moving the player object around
             void Update(double delta_time, glm::vec3 camera);
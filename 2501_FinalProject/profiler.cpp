@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+#include "profiler.h"
+
+namespace game {
+
+const char *profile_zone_names_g[NumProfileZones] = {
+    "Controls", "Update", "Timers", "Waves",
+    "Players", "Subs", "Bosses", "Sharks", "Turrets", "Objects",
+    "Motion", "BroadPhase", "Sweeps", "Javelins", "Torpedoes", "EnemyShots", "PlayerHits", "Events",
+    "Removal", "Render"
+};
+
+
+Profiler::Profiler(int num_frames)
+{
+    num_frames_ = num_frames;
+    num_stored_ = 0;
+    next_ = 0;
+    frame_number_ = 0;
+    times_.assign(num_frames_ * NumProfileZones, 0.0);
+    for (int zone = 0; zone < NumProfileZones; zone++) current_[zone] = 0.0;
+}
+
+
+void Profiler::EndFrame(void)
+{
+    double *frame = &times_[next_ * NumProfileZones];
+    for (int zone = 0; zone < NumProfileZones; zone++) {
+        frame[zone] = current_[zone];
+        current_[zone] = 0.0;
+    }
+    next_ = (next_ + 1) % num_frames_;
+    if (num_stored_ < num_frames_) num_stored_++;
+    frame_number_++;
+}
+
+
+int Profiler::GetFrameIndex(int frame) const
+{
+    return (next_ - num_stored_ + frame + num_frames_) % num_frames_;
+}
+
+
+Profiler::Stats Profiler::GetStats(ProfileZone zone) const
+{
+    Stats stats = { 0.0, 0.0, 0.0 };
+    if (num_stored_ == 0) return stats;
+
+    sorted_.resize(num_stored_);
+    double total = 0.0;
+    for (int i = 0; i < num_stored_; i++) {
+        sorted_[i] = times_[GetFrameIndex(i) * NumProfileZones + zone];
+        total += sorted_[i];
+    }
+
+    // Only the 99th percentile needs to be in place, not the whole order
+    int p99 = std::min(num_stored_ - 1, (int)(0.99 * num_stored_));
+    std::nth_element(sorted_.begin(), sorted_.begin() + p99, sorted_.end());
+    stats.p99 = sorted_[p99];
+    stats.min = *std::min_element(sorted_.begin(), sorted_.begin() + p99 + 1);
+    stats.average = total / num_stored_;
+    return stats;
+}
+
+
+const char *Profiler::GetZoneName(ProfileZone zone)
+{
+    return profile_zone_names_g[zone];
+}
+
+
+void Profiler::WriteCSV(const std::string &filename) const
+{
+    std::ofstream out(filename.c_str());
+    if (out.fail()) {
+        throw(std::runtime_error(std::string("Could not write profile to ") + filename));
+    }
+
+    out << "frame";
+    for (int zone = 0; zone < NumProfileZones; zone++) {
+        out << "," << profile_zone_names_g[zone];
+    }
+    out << "\n";
+
+    long first_frame = frame_number_ - num_stored_;
+    for (int i = 0; i < num_stored_; i++) {
+        const double *frame = &times_[GetFrameIndex(i) * NumProfileZones];
+        out << first_frame + i;
+        for (int zone = 0; zone < NumProfileZones; zone++) {
+            out << "," << frame[zone] * 1000.0;
+        }
+        out << "\n";
+    }
+}
+
+} // namespace game
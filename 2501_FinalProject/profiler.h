@@ -0,0 +1,91 @@
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace game {
+
+    // Parts of a frame that are timed
+    enum ProfileZone { ProfileControls, ProfileUpdate, ProfileTimers, ProfileWaves,
+        ProfilePlayers, ProfileSubs, ProfileBosses, ProfileSharks, ProfileTurrets, ProfileObjects,
+        ProfileMotion, ProfileBroadPhase, ProfileSweeps, ProfileJavelins, ProfileTorpedoes, ProfileEnemyShots, ProfilePlayerHits, ProfileEvents,
+        ProfileRemoval, ProfileRender,
+        // Number of zones, not a zone
+        NumProfileZones };
+
+    // Time spent in each zone, for the last frames
+    // A zone can be entered many times in a frame, its times add up
+    class Profiler {
+
+        public:
+            // Keep the times of the last num_frames frames
+            Profiler(int num_frames);
+
+            // Add time to a zone in the current frame
+            inline void Add(ProfileZone zone, double seconds) { current_[zone] += seconds; }
+
+            // Store the current frame and start a new one
+            void EndFrame(void);
+
+            // Times of a zone over the stored frames, in seconds
+            struct Stats {
+                double min;
+                double average;
+                double p99;
+            };
+            Stats GetStats(ProfileZone zone) const;
+
+            // Frames stored, up to the number kept
+            inline int GetNumFrames(void) const { return num_stored_; }
+
+            static const char *GetZoneName(ProfileZone zone);
+
+            // Write the stored frames, oldest first, one line per frame and
+            // one column per zone in milliseconds
+            // Throws std::runtime_error if the file can't be written
+            void WriteCSV(const std::string &filename) const;
+
+        private:
+            // Index in times_ of a stored frame, 0 being the oldest
+            int GetFrameIndex(int frame) const;
+
+            int num_frames_;
+            int num_stored_;
+            // Where the next frame is stored
+            int next_;
+            long frame_number_;
+
+            // Ring of frames, NumProfileZones times per frame
+            std::vector<double> times_;
+            double current_[NumProfileZones];
+
+            // Kept so GetStats() doesn't allocate
+            mutable std::vector<double> sorted_;
+
+    }; // class Profiler
+
+
+    // Adds the time from its construction to the end of its scope to a zone
+    class ProfileScope {
+
+        public:
+            ProfileScope(Profiler &profiler, ProfileZone zone) : profiler_(profiler), zone_(zone) {
+                start_ = std::chrono::steady_clock::now();
+            }
+            ~ProfileScope() {
+                std::chrono::duration<double> time = std::chrono::steady_clock::now() - start_;
+                profiler_.Add(zone_, time.count());
+            }
+
+        private:
+            Profiler &profiler_;
+            ProfileZone zone_;
+            std::chrono::steady_clock::time_point start_;
+
+    }; // class ProfileScope
+
+} // namespace game
+
+#endif // PROFILER_H_
@@ -0,0 +1,252 @@
+#include <cmath>
+
+#include "ray_circle.h"
+
+#if defined(RAY_CIRCLE_AVX)
+#include <immintrin.h>
+#elif defined(RAY_CIRCLE_SSE)
+#include <emmintrin.h>
+#endif
+
+namespace game {
+
+void SweepBounds(double start, double end, float &t_min, float &t_max)
+{
+    // The nearest floats may be on the wrong side of the doubles
+    t_min = (float)start;
+    if ((double)t_min <= start) t_min = std::nextafter(t_min, INFINITY);
+    t_max = (float)end;
+    if ((double)t_max >= end) t_max = std::nextafter(t_max, -INFINITY);
+}
+
+
+void CircleBatch::Clear(void)
+{
+    x_.clear();
+    y_.clear();
+    r_.clear();
+}
+
+
+void CircleBatch::Add(const glm::vec2 &center, float radius)
+{
+    x_.push_back(center.x);
+    y_.push_back(center.y);
+    r_.push_back(radius);
+}
+
+
+void CircleBatch::Sweep(const glm::vec2 &P, const glm::vec2 &d, float t_min, float t_max)
+{
+    hits_.resize((Size() + 31) / 32);
+    SweepCirclesVector(P, d, t_min, t_max, x_.data(), y_.data(), r_.data(), Size(), hits_.data());
+}
+
+
+void RayBatch::Clear(void)
+{
+    px_.clear();
+    py_.clear();
+    dx_.clear();
+    dy_.clear();
+    t_min_.clear();
+    t_max_.clear();
+}
+
+
+void RayBatch::Reserve(int count)
+{
+    px_.reserve(count);
+    py_.reserve(count);
+    dx_.reserve(count);
+    dy_.reserve(count);
+    t_min_.reserve(count);
+    t_max_.reserve(count);
+    hits_.reserve((count + 31) / 32);
+}
+
+
+void RayBatch::Add(const glm::vec2 &P, const glm::vec2 &d, float t_min, float t_max)
+{
+    px_.push_back(P.x);
+    py_.push_back(P.y);
+    dx_.push_back(d.x);
+    dy_.push_back(d.y);
+    t_min_.push_back(t_min);
+    t_max_.push_back(t_max);
+}
+
+
+void RayBatch::Sweep(const glm::vec2 &center, float radius)
+{
+    hits_.resize((Size() + 31) / 32);
+    SweepRaysVector(px_.data(), py_.data(), dx_.data(), dy_.data(), t_min_.data(), t_max_.data(), Size(), center, radius, hits_.data());
+}
+
+
+// One ray against one circle, as in RayCollision() and Bullet::CheckCollision()
+static inline bool SweepOne(float px, float py, float dx, float dy, float t_min, float t_max, float cx, float cy, float r)
+{
+    float cpx = px - cx;
+    float cpy = py - cy;
+    float a = dx * dx + dy * dy;
+    float b = (2.0f * dx) * cpx + (2.0f * dy) * cpy;
+    float c = (cpx * cpx + cpy * cpy) - r * r;
+
+    float delta = b * b - (4.0f * a) * c;
+    if (delta < 0.0f) return false;
+
+    float sq = std::sqrt(delta);
+    float t1 = (-b + sq) / (2.0f * a);
+    float t2 = (-b - sq) / (2.0f * a);
+    return (t1 >= t_min && t1 <= t_max) || (t2 >= t_min && t2 <= t_max);
+}
+
+
+// Set or clear bit i of mask
+static inline void SetBit(unsigned int *mask, int i, bool hit)
+{
+    if (hit) mask[i >> 5] |= 1u << (i & 31);
+    else mask[i >> 5] &= ~(1u << (i & 31));
+}
+
+
+void SweepCirclesScalar(const glm::vec2 &P, const glm::vec2 &d, float t_min, float t_max,
+    const float *cx, const float *cy, const float *r, int count, unsigned int *mask)
+{
+    for (int i = 0; i < count; i++) {
+        SetBit(mask, i, SweepOne(P.x, P.y, d.x, d.y, t_min, t_max, cx[i], cy[i], r[i]));
+    }
+}
+
+
+void SweepRaysScalar(const float *px, const float *py, const float *dx, const float *dy,
+    const float *t_min, const float *t_max, int count, const glm::vec2 &C, float r, unsigned int *mask)
+{
+    for (int i = 0; i < count; i++) {
+        SetBit(mask, i, SweepOne(px[i], py[i], dx[i], dy[i], t_min[i], t_max[i], C.x, C.y, r));
+    }
+}
+
+
+// The vector kernels run SweepOne() on a register of rays and circles
+// Lanes whose delta is negative take the square root of a negative
+// number; the NaN fails every comparison, so they miss like in SweepOne()
+#if defined(RAY_CIRCLE_AVX)
+
+#define VEC_WIDTH 8
+typedef __m256 vec_t;
+#define VEC_SET1 _mm256_set1_ps
+#define VEC_LOAD _mm256_loadu_ps
+#define VEC_ADD _mm256_add_ps
+#define VEC_SUB _mm256_sub_ps
+#define VEC_MUL _mm256_mul_ps
+#define VEC_DIV _mm256_div_ps
+#define VEC_SQRT _mm256_sqrt_ps
+#define VEC_AND _mm256_and_ps
+#define VEC_OR _mm256_or_ps
+#define VEC_GE(a, b) _mm256_cmp_ps(a, b, _CMP_GE_OQ)
+#define VEC_LE(a, b) _mm256_cmp_ps(a, b, _CMP_LE_OQ)
+#define VEC_MASK _mm256_movemask_ps
+
+#elif defined(RAY_CIRCLE_SSE)
+
+#define VEC_WIDTH 4
+typedef __m128 vec_t;
+#define VEC_SET1 _mm_set1_ps
+#define VEC_LOAD _mm_loadu_ps
+#define VEC_ADD _mm_add_ps
+#define VEC_SUB _mm_sub_ps
+#define VEC_MUL _mm_mul_ps
+#define VEC_DIV _mm_div_ps
+#define VEC_SQRT _mm_sqrt_ps
+#define VEC_AND _mm_and_ps
+#define VEC_OR _mm_or_ps
+#define VEC_GE _mm_cmpge_ps
+#define VEC_LE _mm_cmple_ps
+#define VEC_MASK _mm_movemask_ps
+
+#endif
+
+#if defined(VEC_WIDTH)
+
+// Bits of the lanes that hit
+static inline unsigned int SweepLanes(vec_t px, vec_t py, vec_t dx, vec_t dy, vec_t t_min, vec_t t_max, vec_t cx, vec_t cy, vec_t r)
+{
+    const vec_t two = VEC_SET1(2.0f);
+    const vec_t four = VEC_SET1(4.0f);
+    const vec_t zero = VEC_SET1(0.0f);
+
+    vec_t cpx = VEC_SUB(px, cx);
+    vec_t cpy = VEC_SUB(py, cy);
+    vec_t a = VEC_ADD(VEC_MUL(dx, dx), VEC_MUL(dy, dy));
+    vec_t b = VEC_ADD(VEC_MUL(VEC_MUL(two, dx), cpx), VEC_MUL(VEC_MUL(two, dy), cpy));
+    vec_t c = VEC_SUB(VEC_ADD(VEC_MUL(cpx, cpx), VEC_MUL(cpy, cpy)), VEC_MUL(r, r));
+
+    vec_t delta = VEC_SUB(VEC_MUL(b, b), VEC_MUL(VEC_MUL(four, a), c));
+    vec_t sq = VEC_SQRT(delta);
+    vec_t minus_b = VEC_SUB(zero, b);
+    vec_t two_a = VEC_MUL(two, a);
+    vec_t t1 = VEC_DIV(VEC_ADD(minus_b, sq), two_a);
+    vec_t t2 = VEC_DIV(VEC_SUB(minus_b, sq), two_a);
+
+    vec_t hit1 = VEC_AND(VEC_GE(t1, t_min), VEC_LE(t1, t_max));
+    vec_t hit2 = VEC_AND(VEC_GE(t2, t_min), VEC_LE(t2, t_max));
+    return (unsigned int)VEC_MASK(VEC_OR(hit1, hit2));
+}
+
+
+// Store the bits of the lanes starting at i; a register never spans two
+// words of the mask, since the width divides 32
+static inline void StoreLanes(unsigned int *mask, int i, unsigned int bits)
+{
+    const unsigned int lanes = (1u << VEC_WIDTH) - 1u;
+    int shift = i & 31;
+    mask[i >> 5] = (mask[i >> 5] & ~(lanes << shift)) | (bits << shift);
+}
+
+#endif
+
+
+void SweepCirclesVector(const glm::vec2 &P, const glm::vec2 &d, float t_min, float t_max,
+    const float *cx, const float *cy, const float *r, int count, unsigned int *mask)
+{
+    int i = 0;
+#if defined(VEC_WIDTH)
+    vec_t px = VEC_SET1(P.x);
+    vec_t py = VEC_SET1(P.y);
+    vec_t dx = VEC_SET1(d.x);
+    vec_t dy = VEC_SET1(d.y);
+    vec_t lo = VEC_SET1(t_min);
+    vec_t hi = VEC_SET1(t_max);
+    for (; i + VEC_WIDTH <= count; i += VEC_WIDTH) {
+        StoreLanes(mask, i, SweepLanes(px, py, dx, dy, lo, hi, VEC_LOAD(cx + i), VEC_LOAD(cy + i), VEC_LOAD(r + i)));
+    }
+#endif
+    // Circles left over after the last full vector
+    for (; i < count; i++) {
+        SetBit(mask, i, SweepOne(P.x, P.y, d.x, d.y, t_min, t_max, cx[i], cy[i], r[i]));
+    }
+}
+
+
+void SweepRaysVector(const float *px, const float *py, const float *dx, const float *dy,
+    const float *t_min, const float *t_max, int count, const glm::vec2 &C, float r, unsigned int *mask)
+{
+    int i = 0;
+#if defined(VEC_WIDTH)
+    vec_t cx = VEC_SET1(C.x);
+    vec_t cy = VEC_SET1(C.y);
+    vec_t radius = VEC_SET1(r);
+    for (; i + VEC_WIDTH <= count; i += VEC_WIDTH) {
+        StoreLanes(mask, i, SweepLanes(VEC_LOAD(px + i), VEC_LOAD(py + i), VEC_LOAD(dx + i), VEC_LOAD(dy + i),
+            VEC_LOAD(t_min + i), VEC_LOAD(t_max + i), cx, cy, radius));
+    }
+#endif
+    // Rays left over after the last full vector
+    for (; i < count; i++) {
+        SetBit(mask, i, SweepOne(px[i], py[i], dx[i], dy[i], t_min[i], t_max[i], C.x, C.y, r));
+    }
+}
+
+} // namespace game
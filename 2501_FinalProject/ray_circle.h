@@ -0,0 +1,100 @@
+#ifndef RAY_CIRCLE_H_
+#define RAY_CIRCLE_H_
+
+#include <vector>
+#include <glm/glm.hpp>
+
+// Pick the widest vector instructions the compiler targets
+// Define RAY_CIRCLE_SCALAR to force the plain C++ loops
+#if !defined(RAY_CIRCLE_SCALAR)
+#if defined(__AVX__)
+#define RAY_CIRCLE_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RAY_CIRCLE_SSE
+#endif
+#endif
+
+namespace game {
+
+    // Batched ray-circle tests for projectiles
+    // A projectile covers the ray P + t d, and hits a circle when one of
+    // the points where the ray crosses it has t in the range covered in
+    // the last update. The math is the one of Bullet::CheckCollision, in
+    // the same order and precision, so a batch gives the same answers
+
+    // Range of float parameters t with start < t < end, as inclusive
+    // bounds t_min <= t <= t_max; t_min > t_max if there are none
+    void SweepBounds(double start, double end, float &t_min, float &t_max);
+
+    // Circles tested against one ray, one array per value
+    class CircleBatch {
+
+        public:
+            CircleBatch(void) {}
+
+            void Clear(void);
+            void Add(const glm::vec2 &center, float radius);
+            inline int Size(void) const { return (int)x_.size(); }
+
+            // Test the ray against every circle
+            void Sweep(const glm::vec2 &P, const glm::vec2 &d, float t_min, float t_max);
+
+            // Whether the last Sweep() hit circle i
+            inline bool GetHit(int i) const { return (hits_[i >> 5] >> (i & 31)) & 1u; }
+
+        private:
+            std::vector<float> x_;
+            std::vector<float> y_;
+            std::vector<float> r_;
+            // One bit per circle
+            std::vector<unsigned int> hits_;
+
+    }; // class CircleBatch
+
+    // Rays tested against one circle, one array per value
+    class RayBatch {
+
+        public:
+            RayBatch(void) {}
+
+            void Clear(void);
+
+            // Make room for count rays, so adding them never reallocates
+            void Reserve(int count);
+
+            void Add(const glm::vec2 &P, const glm::vec2 &d, float t_min, float t_max);
+            inline int Size(void) const { return (int)px_.size(); }
+
+            // Test every ray against the circle
+            void Sweep(const glm::vec2 &center, float radius);
+
+            // Whether ray i hit the circle in the last Sweep()
+            inline bool GetHit(int i) const { return (hits_[i >> 5] >> (i & 31)) & 1u; }
+
+        private:
+            std::vector<float> px_;
+            std::vector<float> py_;
+            std::vector<float> dx_;
+            std::vector<float> dy_;
+            std::vector<float> t_min_;
+            std::vector<float> t_max_;
+            // One bit per ray
+            std::vector<unsigned int> hits_;
+
+    }; // class RayBatch
+
+    // Kernels, setting bit i of mask for each hit and clearing the others
+    // mask holds (count + 31) / 32 words
+    // The vectorized ones fall back to the scalar ones without SSE or AVX
+    void SweepCirclesScalar(const glm::vec2 &P, const glm::vec2 &d, float t_min, float t_max,
+        const float *cx, const float *cy, const float *r, int count, unsigned int *mask);
+    void SweepCirclesVector(const glm::vec2 &P, const glm::vec2 &d, float t_min, float t_max,
+        const float *cx, const float *cy, const float *r, int count, unsigned int *mask);
+    void SweepRaysScalar(const float *px, const float *py, const float *dx, const float *dy,
+        const float *t_min, const float *t_max, int count, const glm::vec2 &C, float r, unsigned int *mask);
+    void SweepRaysVector(const float *px, const float *py, const float *dx, const float *dy,
+        const float *t_min, const float *t_max, int count, const glm::vec2 &C, float r, unsigned int *mask);
+
+} // namespace game
+
+#endif // RAY_CIRCLE_H_
@@ -0,0 +1,195 @@
+#include <algorithm>
+#define GLM_FORCE_RADIANS
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "render_queue.h"
+#include "render_state.h"
+#include "text_game_object.h"
+
+namespace game {
+
+// Layers from this one on are not drawn by the sprite batch
+const int first_unbatched_layer_g = HudLayer;
+
+
+RenderQueue::RenderQueue(void)
+{
+    sequence_ = 0;
+}
+
+
+void RenderQueue::Clear(void)
+{
+    commands_.clear();
+    sequence_ = 0;
+}
+
+
+int RenderQueue::GetGeometryId(const Geometry *geometry)
+{
+    for (int i = 0; i < geometries_.size(); i++) {
+        if (geometries_[i] == geometry) return i;
+    }
+    geometries_.push_back(geometry);
+    return (int)geometries_.size() - 1;
+}
+
+
+const RenderQueue::ShaderUniforms &RenderQueue::GetShaderUniforms(const Shader *shader)
+{
+    for (int i = 0; i < shader_uniforms_.size(); i++) {
+        if (shader_uniforms_[i].shader == shader) return shader_uniforms_[i];
+    }
+    ShaderUniforms uniforms;
+    uniforms.shader = shader;
+    uniforms.view_matrix = shader->GetUniform("view_matrix");
+    uniforms.transformation_matrix = shader->GetUniform("transformation_matrix");
+    uniforms.text_len = shader->GetUniform("text_len");
+    uniforms.text_content = shader->GetUniform("text_content");
+    shader_uniforms_.push_back(uniforms);
+    return shader_uniforms_.back();
+}
+
+
+void RenderQueue::Add(RenderLayer layer, const DrawItem *item)
+{
+    // Key, from the most significant bits: layer (4 bits), shader program
+    // (12), texture (12), geometry (4) and the order of addition (32)
+    // OpenGL names are small numbers; larger ones only sort less well
+    const DrawRecord &record = *item->record;
+    uint64_t program = record.shader ? record.shader->GetShaderProgram() : 0;
+    uint64_t texture = record.texture;
+    uint64_t geometry = GetGeometryId(record.geometry);
+
+    DrawCommand command;
+    command.key = ((uint64_t)layer << 60) | ((program & 0xfff) << 48) | ((texture & 0xfff) << 36) | ((geometry & 0xf) << 32) | sequence_++;
+    command.item = item;
+    commands_.push_back(command);
+}
+
+
+void RenderQueue::Sort(void)
+{
+    // Keys are unique, so the order is the same every frame
+    std::sort(commands_.begin(), commands_.end(), [](const DrawCommand &a, const DrawCommand &b) {
+        return a.key < b.key;
+    });
+}
+
+
+void RenderQueue::Submit(const RenderSnapshot &snapshot, SpriteBatch &batch, const glm::mat4 &view_matrix)
+{
+    bool flushed = false;
+    for (int i = 0; i < commands_.size(); i++) {
+        int layer = (int)(commands_[i].key >> 60);
+        if (!flushed && layer >= first_unbatched_layer_g) {
+            batch.Flush();
+            flushed = true;
+        }
+        Draw(*commands_[i].item, snapshot, batch, view_matrix);
+    }
+    if (!flushed) batch.Flush();
+}
+
+
+void RenderQueue::Draw(const DrawItem &item, const RenderSnapshot &snapshot, SpriteBatch &batch, const glm::mat4 &view_matrix)
+{
+    const DrawRecord &record = *item.record;
+    switch (record.kind) {
+        case SpriteDraw:
+            batch.Add(record.texture, item.position, record.size, item.angle, record.uv_rect);
+            break;
+        case OffsetSpriteDraw:
+            batch.Add(record.texture, item.parent_position + record.position, record.size, item.angle, record.uv_rect);
+            break;
+        case TextDraw:
+            DrawText(item, snapshot, view_matrix);
+            break;
+        case ShapeDraw:
+            DrawShape(item, view_matrix);
+            break;
+        case ParticleDraw: {
+            // The system sits at its current transform in its parent's
+            // blended frame
+            glm::mat4 scaling_matrix = glm::scale(glm::mat4(1.0f), glm::vec3(record.scale, record.scale, 1.0));
+            glm::mat4 rotation_matrix = glm::rotate(glm::mat4(1.0f), record.angle, glm::vec3(0.0, 0.0, 1.0));
+            glm::mat4 translation_matrix = glm::translate(glm::mat4(1.0f), record.position);
+            glm::mat4 parent_rotation_matrix = glm::rotate(glm::mat4(1.0f), item.parent_angle, glm::vec3(0.0, 0.0, 1.0));
+            glm::mat4 parent_translation_matrix = glm::translate(glm::mat4(1.0f), item.parent_position);
+            glm::mat4 parent_transformation_matrix = parent_translation_matrix * parent_rotation_matrix;
+            glm::mat4 transformation_matrix = parent_transformation_matrix * translation_matrix * rotation_matrix * scaling_matrix;
+
+            // Queue the particles with the pool, which draws every system at once
+            record.pool->Add(record.effect, record.texture, transformation_matrix, record.reset_timer, record.num_particles);
+            break;
+        }
+    }
+}
+
+
+void RenderQueue::DrawText(const DrawItem &item, const RenderSnapshot &snapshot, const glm::mat4 &view_matrix)
+{
+    const DrawRecord &record = *item.record;
+    Shader *shader = record.shader;
+    const ShaderUniforms &uniforms = GetShaderUniforms(shader);
+
+    // Set up the shader
+    shader->Enable();
+
+    // Set up the view matrix
+    shader->SetUniformMat4(uniforms.view_matrix, view_matrix);
+
+    // Setup the transformation matrix for the shader
+    glm::mat4 scaling_matrix = glm::scale(glm::mat4(1.0f), glm::vec3(record.size.x, record.size.y, 1.0f));
+    glm::mat4 rotation_matrix = glm::rotate(glm::mat4(1.0f), item.angle, glm::vec3(0.0, 0.0, 1.0));
+    glm::mat4 translation_matrix = glm::translate(glm::mat4(1.0f), item.position);
+    glm::mat4 transformation_matrix = translation_matrix * rotation_matrix * scaling_matrix;
+    shader->SetUniformMat4(uniforms.transformation_matrix, transformation_matrix);
+
+    // Set up the geometry
+    record.geometry->SetGeometry(shader->GetShaderProgram());
+
+    RenderState::BindTexture(record.texture);
+
+    // Set the text: its length, then its characters
+    shader->SetUniform1i(uniforms.text_len, record.text_length);
+    GLint data[TEXT_LENGTH];
+    for (int i = 0; i < record.text_length; i++){
+        data[i] = snapshot.text[record.text_start + i];
+    }
+    shader->SetUniformIntArray(uniforms.text_content, record.text_length, data);
+
+    // Draw the entity
+    glDrawElements(GL_TRIANGLES, record.geometry->GetSize(), GL_UNSIGNED_INT, 0);
+}
+
+
+void RenderQueue::DrawShape(const DrawItem &item, const glm::mat4 &view_matrix)
+{
+    const DrawRecord &record = *item.record;
+    Shader *shader = record.shader;
+    const ShaderUniforms &uniforms = GetShaderUniforms(shader);
+
+    // Set up the shader
+    shader->Enable();
+
+    // Set up the view matrix
+    shader->SetUniformMat4(uniforms.view_matrix, view_matrix);
+
+    // Setup the transformation matrix for the shader
+    glm::mat4 scaling_matrix = glm::scale(glm::mat4(1.0f), glm::vec3(record.size.x, record.size.y, 1.0f));
+    glm::mat4 rotation_matrix = glm::rotate(glm::mat4(1.0f), item.angle, glm::vec3(0.0, 0.0, 1.0));
+    glm::mat4 translation_matrix = glm::translate(glm::mat4(1.0f), item.position);
+    glm::mat4 transformation_matrix = translation_matrix * rotation_matrix * scaling_matrix;
+    shader->SetUniformMat4(uniforms.transformation_matrix, transformation_matrix);
+
+    // Set up the geometry
+    record.geometry->SetGeometry(shader->GetShaderProgram());
+
+    RenderState::BindTexture(record.texture);
+
+    // Draw the entity
+    glDrawElements(GL_TRIANGLES, record.geometry->GetSize(), GL_UNSIGNED_INT, 0);
+}
+
+} // namespace game
@@ -0,0 +1,90 @@
+#ifndef RENDER_QUEUE_H_
+#define RENDER_QUEUE_H_
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "render_snapshot.h"
+#include "sprite_batch.h"
+
+namespace game {
+
+    // Layers are drawn in this order
+    // The sprite layers go through the sprite batch, where sprites drawn
+    // earlier stay in front: the player in front of the other sprites,
+    // and the background behind everything
+    enum RenderLayer {
+        PlayerLayer,
+        SpriteLayer,
+        BackgroundLayer,
+        // Text, in front of the world (and drawn after the sprite batch)
+        HudLayer,
+        // Particles, added together without depth
+        EffectsLayer,
+        NumRenderLayers };
+
+    // Draws collected for a frame and sorted, so that draws sharing a
+    // shader, texture and geometry follow each other
+    class RenderQueue {
+
+        public:
+            RenderQueue(void);
+
+            // Remove the draws of the last frame
+            void Clear(void);
+
+            // Add an item of a snapshot to draw in a layer
+            // Within a layer and state, items are drawn in the order added
+            void Add(RenderLayer layer, const DrawItem *item);
+
+            // Sort the draws by layer, then shader, texture and geometry
+            void Sort(void);
+
+            // Render all draws, flushing the sprite batch after the sprite
+            // layers
+            void Submit(const RenderSnapshot &snapshot, SpriteBatch &batch, const glm::mat4 &view_matrix);
+
+            // Draw one item of a snapshot
+            // Sprites are added to the batch and particles to their pool;
+            // text and shapes have their own shader and draw right away
+            void Draw(const DrawItem &item, const RenderSnapshot &snapshot, SpriteBatch &batch, const glm::mat4 &view_matrix);
+
+            inline int Size(void) const { return (int)commands_.size(); }
+
+        private:
+            struct DrawCommand {
+                uint64_t key;
+                const DrawItem *item;
+            };
+
+            // Uniforms set by the draws with their own shader, looked up
+            // once per shader
+            struct ShaderUniforms {
+                const Shader *shader;
+                UniformHandle view_matrix;
+                UniformHandle transformation_matrix;
+                UniformHandle text_len;
+                UniformHandle text_content;
+            };
+
+            // Small number for a geometry, so it fits in the sort key
+            int GetGeometryId(const Geometry *geometry);
+
+            // Uniforms of a shader, looked up the first time it draws
+            const ShaderUniforms &GetShaderUniforms(const Shader *shader);
+
+            // Draws of the items with their own shader
+            void DrawText(const DrawItem &item, const RenderSnapshot &snapshot, const glm::mat4 &view_matrix);
+            void DrawShape(const DrawItem &item, const glm::mat4 &view_matrix);
+
+            std::vector<DrawCommand> commands_;
+            std::vector<const Geometry *> geometries_;
+            std::vector<ShaderUniforms> shader_uniforms_;
+            unsigned int sequence_;
+
+    }; // class RenderQueue
+
+} // namespace game
+
+#endif // RENDER_QUEUE_H_
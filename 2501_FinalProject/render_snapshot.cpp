@@ -0,0 +1,180 @@
+#define GLM_FORCE_RADIANS
+#include <glm/gtc/matrix_transform.hpp>
+#include <cmath>
+
+#include "render_snapshot.h"
+
+namespace game {
+
+void RenderSnapshot::Clear(void)
+{
+    records.clear();
+    text.clear();
+    overlay_start = 0;
+    show_profile = false;
+}
+
+
+DrawRecord &RenderSnapshot::AddRecord(void)
+{
+    DrawRecord record;
+    record.kind = SpriteDraw;
+    record.type = GenericObj;
+    record.awake = true;
+    record.shader = nullptr;
+    record.geometry = nullptr;
+    record.texture = 0;
+    record.uv_rect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+    record.previous_position = glm::vec3(0.0f);
+    record.position = glm::vec3(0.0f);
+    record.previous_angle = 0.0f;
+    record.angle = 0.0f;
+    record.size = glm::vec2(1.0f);
+    record.scale = 1.0f;
+    record.parent = -1;
+    record.parent_position = glm::vec3(0.0f);
+    record.parent_angle = 0.0f;
+    record.text_start = 0;
+    record.text_length = 0;
+    record.pool = nullptr;
+    record.effect = 0;
+    record.reset_timer = 0.0;
+    record.num_particles = -1;
+    records.push_back(record);
+    return records.back();
+}
+
+
+void PlaceDrawItem(const DrawRecord &record, float alpha, DrawItem &item)
+{
+    item.record = &record;
+    item.position = record.previous_position + alpha * (record.position - record.previous_position);
+
+    // Blend the angle along the shortest arc, since angles wrap around
+    float pi = glm::pi<float>();
+    float angle_change = record.angle - record.previous_angle;
+    if (angle_change > pi) angle_change -= 2.0f * pi;
+    if (angle_change < -pi) angle_change += 2.0f * pi;
+    item.angle = record.previous_angle + alpha * angle_change;
+
+    item.parent_position = record.parent_position;
+    item.parent_angle = record.parent_angle;
+}
+
+
+void GetDrawBounds(const DrawItem &item, glm::vec2 &center, glm::vec2 &half_size)
+{
+    const DrawRecord &record = *item.record;
+    switch (record.kind) {
+        case OffsetSpriteDraw: {
+            // A square sprite, so half its diagonal covers every angle
+            glm::vec3 position = item.parent_position + record.position;
+            center = glm::vec2(position.x, position.y);
+            half_size = glm::vec2(0.75f * record.scale);
+            break;
+        }
+        case ParticleDraw: {
+            // The emitter sits at its position in its parent's frame, and
+            // the effect reaches furthest at the system's current time
+            glm::mat4 parent_rotation_matrix = glm::rotate(glm::mat4(1.0f), item.parent_angle, glm::vec3(0.0, 0.0, 1.0));
+            glm::mat4 parent_translation_matrix = glm::translate(glm::mat4(1.0f), item.parent_position);
+            glm::vec4 emitter = parent_translation_matrix * parent_rotation_matrix * glm::vec4(record.position, 1.0f);
+            center = glm::vec2(emitter.x, emitter.y);
+            half_size = glm::vec2(record.scale * record.pool->GetReach(record.effect, record.reset_timer));
+            break;
+        }
+        default: {
+            // Box around the sprite, turned by its angle
+            glm::vec2 size = 0.5f * record.size;
+            float c = fabs(cos(item.angle));
+            float s = fabs(sin(item.angle));
+            center = glm::vec2(item.position.x, item.position.y);
+            half_size = glm::vec2(c * size.x + s * size.y, s * size.x + c * size.y);
+            break;
+        }
+    }
+}
+
+
+SnapshotBuffer::SnapshotBuffer(void)
+{
+    back_ = 0;
+    has_front_ = false;
+    drawing_ = false;
+    pending_ = false;
+    closed_ = false;
+    draw_time_ = 0.0;
+    snapshots_[0].Clear();
+    snapshots_[1].Clear();
+}
+
+
+RenderSnapshot &SnapshotBuffer::GetBack(void)
+{
+    // Once a pending snapshot is withdrawn, only Publish() changes which
+    // snapshot is the back one, so the game fills it without the lock
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_ = false;
+    return snapshots_[back_];
+}
+
+
+void SnapshotBuffer::Publish(void)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (drawing_) {
+            pending_ = true;
+            return;
+        }
+        back_ = 1 - back_;
+        has_front_ = true;
+    }
+    published_.notify_one();
+}
+
+
+const RenderSnapshot *SnapshotBuffer::Acquire(void)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    published_.wait(lock, [this]() { return closed_ || has_front_; });
+    if (closed_) return nullptr;
+    drawing_ = true;
+    return &snapshots_[1 - back_];
+}
+
+
+void SnapshotBuffer::Release(double seconds)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    drawing_ = false;
+    draw_time_ += seconds;
+
+    // Swap in the snapshot published during the draw
+    if (pending_) {
+        back_ = 1 - back_;
+        has_front_ = true;
+        pending_ = false;
+    }
+}
+
+
+double SnapshotBuffer::TakeDrawTime(void)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    double seconds = draw_time_;
+    draw_time_ = 0.0;
+    return seconds;
+}
+
+
+void SnapshotBuffer::Close(void)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+    }
+    published_.notify_one();
+}
+
+} // namespace game
@@ -0,0 +1,166 @@
+#ifndef RENDER_SNAPSHOT_H_
+#define RENDER_SNAPSHOT_H_
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include <glm/glm.hpp>
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+#include "shader.h"
+#include "geometry.h"
+#include "game_object.h"
+#include "particle_pool.h"
+
+namespace game {
+
+    // How a record is drawn
+    enum DrawKind {
+        // A sprite, through the sprite batch
+        SpriteDraw,
+        // A sprite at a fixed offset from its parent, not turning with it
+        OffsetSpriteDraw,
+        // A line of text, with the record's shader
+        TextDraw,
+        // A shape drawn with the record's shader
+        ShapeDraw,
+        // The particles of an effect, placed in the parent's frame
+        ParticleDraw };
+
+    // What one object draws, copied out of the game after a step
+    struct DrawRecord {
+        DrawKind kind;
+        ObjectType type;
+        // Sleeping objects are kept for their children, but not drawn
+        bool awake;
+
+        Shader *shader;
+        Geometry *geometry;
+        GLuint texture;
+        glm::vec4 uv_rect;
+
+        // Transform of the last two steps, the same for objects added in
+        // the last step
+        glm::vec3 previous_position;
+        glm::vec3 position;
+        float previous_angle;
+        float angle;
+
+        // Size drawn, and the scale it comes from
+        glm::vec2 size;
+        float scale;
+
+        // Index of the parent's record, -1 if there is none; the parent's
+        // last known transform is used once it is gone
+        int parent;
+        glm::vec3 parent_position;
+        float parent_angle;
+
+        // Characters of a text record, in the snapshot's text
+        int text_start;
+        int text_length;
+
+        // Particle effect, in the pool that draws it
+        ParticlePool *pool;
+        int effect;
+        double reset_timer;
+        int num_particles;
+    };
+
+    // The state a frame is drawn from, copied out of the game after its
+    // steps, so drawing never looks at the game objects
+    struct RenderSnapshot {
+        // Game objects, in the game's order, then the lines of the profiler
+        // overlay from overlay_start on
+        std::vector<DrawRecord> records;
+        int overlay_start;
+        std::vector<char> text;
+
+        glm::vec3 previous_camera_position;
+        glm::vec3 camera_position;
+
+        int window_width;
+        int window_height;
+        int framebuffer_width;
+        int framebuffer_height;
+
+        // Clock time of the snapshot, and time left over after its last
+        // step, so frames drawn later blend further towards the last step
+        double time;
+        double lag;
+
+        bool show_profile;
+
+        // Remove the records, keeping the memory
+        void Clear(void);
+
+        // Add a record with no parent and nothing else to draw, and return it
+        DrawRecord &AddRecord(void);
+    };
+
+    // A record placed for one frame, blended between its last two steps,
+    // with the blended transform of its parent
+    struct DrawItem {
+        const DrawRecord *record;
+        glm::vec3 position;
+        float angle;
+        glm::vec3 parent_position;
+        float parent_angle;
+    };
+
+    // Blend a record between its last two steps (alpha = 0 is the previous
+    // one); the parent's transform is set apart
+    void PlaceDrawItem(const DrawRecord &record, float alpha, DrawItem &item);
+
+    // Box around everything an item draws, as its center and half size in
+    // world units
+    void GetDrawBounds(const DrawItem &item, glm::vec2 &center, glm::vec2 &half_size);
+
+    // Two snapshots: the game fills the back one while the renderer draws
+    // the front one, and publishing swaps them
+    // The game never waits for the renderer: a snapshot published while the
+    // front one is being drawn is swapped in once the draw is done, unless
+    // the game starts filling the next one first
+    class SnapshotBuffer {
+
+        public:
+            SnapshotBuffer(void);
+
+            // Snapshot for the game to fill, replacing one that waits for
+            // the renderer to be done
+            RenderSnapshot &GetBack(void);
+
+            // Make the back snapshot the newest
+            void Publish(void);
+
+            // Get the newest snapshot to draw, waiting for the first one, or
+            // nullptr once the buffer is closed
+            const RenderSnapshot *Acquire(void);
+
+            // Done with the acquired snapshot, after seconds of drawing
+            void Release(double seconds);
+
+            // Seconds of drawing released since the last call
+            double TakeDrawTime(void);
+
+            // Make Acquire() return nullptr from now on
+            void Close(void);
+
+        private:
+            RenderSnapshot snapshots_[2];
+            int back_;
+
+            std::mutex mutex_;
+            std::condition_variable published_;
+            bool has_front_;
+            bool drawing_;
+            bool pending_;
+            bool closed_;
+            double draw_time_;
+
+    }; // class SnapshotBuffer
+
+} // namespace game
+
+#endif // RENDER_SNAPSHOT_H_
@@ -0,0 +1,111 @@
+#include "render_state.h"
+
+namespace game {
+
+// Values that never match a real setting, for state not known yet
+const GLuint unknown_name_g = 0xffffffffu;
+const int unknown_flag_g = -1;
+
+GLuint RenderState::program_ = unknown_name_g;
+GLuint RenderState::texture_ = unknown_name_g;
+GLuint RenderState::vertex_array_ = unknown_name_g;
+int RenderState::depth_test_ = unknown_flag_g;
+GLenum RenderState::depth_func_ = 0;
+int RenderState::blend_ = unknown_flag_g;
+GLenum RenderState::blend_source_ = 0;
+GLenum RenderState::blend_destination_ = 0;
+int RenderState::num_changes_ = 0;
+int RenderState::num_skipped_ = 0;
+
+
+bool RenderState::Changed(bool changed)
+{
+    if (changed) num_changes_++;
+    else num_skipped_++;
+    return changed;
+}
+
+
+void RenderState::UseProgram(GLuint program)
+{
+    if (!Changed(program_ != program)) return;
+    program_ = program;
+    glUseProgram(program);
+}
+
+
+void RenderState::BindTexture(GLuint texture)
+{
+    if (!Changed(texture_ != texture)) return;
+    texture_ = texture;
+    glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+
+void RenderState::BindVertexArray(GLuint vertex_array)
+{
+    if (!Changed(vertex_array_ != vertex_array)) return;
+    vertex_array_ = vertex_array;
+    glBindVertexArray(vertex_array);
+}
+
+
+void RenderState::SetDepthTest(bool enabled, GLenum func)
+{
+    if (enabled) {
+        if (Changed(depth_test_ != 1)) {
+            depth_test_ = 1;
+            glEnable(GL_DEPTH_TEST);
+        }
+        if (Changed(depth_func_ != func)) {
+            depth_func_ = func;
+            glDepthFunc(func);
+        }
+    }
+    else if (Changed(depth_test_ != 0)) {
+        depth_test_ = 0;
+        glDisable(GL_DEPTH_TEST);
+    }
+}
+
+
+void RenderState::SetBlend(bool enabled, GLenum source, GLenum destination)
+{
+    if (enabled) {
+        if (Changed(blend_ != 1)) {
+            blend_ = 1;
+            glEnable(GL_BLEND);
+        }
+        if (Changed(blend_source_ != source || blend_destination_ != destination)) {
+            blend_source_ = source;
+            blend_destination_ = destination;
+            glBlendFunc(source, destination);
+        }
+    }
+    else if (Changed(blend_ != 0)) {
+        blend_ = 0;
+        glDisable(GL_BLEND);
+    }
+}
+
+
+void RenderState::Reset(void)
+{
+    program_ = unknown_name_g;
+    texture_ = unknown_name_g;
+    vertex_array_ = unknown_name_g;
+    depth_test_ = unknown_flag_g;
+    depth_func_ = 0;
+    blend_ = unknown_flag_g;
+    blend_source_ = 0;
+    blend_destination_ = 0;
+}
+
+
+void RenderState::ClearCounters(void)
+{
+    num_changes_ = 0;
+    num_skipped_ = 0;
+}
+
+} // namespace game
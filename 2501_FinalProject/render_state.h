@@ -0,0 +1,55 @@
+#ifndef RENDER_STATE_H_
+#define RENDER_STATE_H_
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+namespace game {
+
+    // Remembers the OpenGL state set through it and skips calls that
+    // would set the same state again
+    // Only state changed through this class is known; call Reset() after
+    // changing it directly
+    class RenderState {
+
+        public:
+            // Same as glUseProgram, glBindTexture (unit 0) and glBindVertexArray
+            static void UseProgram(GLuint program);
+            static void BindTexture(GLuint texture);
+            static void BindVertexArray(GLuint vertex_array);
+
+            // Depth test with a comparison function, or no depth test
+            static void SetDepthTest(bool enabled, GLenum func = GL_LESS);
+
+            // Blending with a blend function, or no blending
+            static void SetBlend(bool enabled, GLenum source = GL_ONE, GLenum destination = GL_ZERO);
+
+            // Forget the cached state, so the next calls are all made
+            static void Reset(void);
+
+            // Calls made and skipped since the counters were last cleared
+            static inline int GetNumChanges(void) { return num_changes_; }
+            static inline int GetNumSkipped(void) { return num_skipped_; }
+            static void ClearCounters(void);
+
+        private:
+            // Records a call; returns true if the state must be set
+            static bool Changed(bool changed);
+
+            static GLuint program_;
+            static GLuint texture_;
+            static GLuint vertex_array_;
+            static int depth_test_;
+            static GLenum depth_func_;
+            static int blend_;
+            static GLenum blend_source_;
+            static GLenum blend_destination_;
+
+            static int num_changes_;
+            static int num_skipped_;
+
+    }; // class RenderState
+
+} // namespace game
+
+#endif // RENDER_STATE_H_
@@ -1,9 +1,11 @@
+#include <cstring>
 #include <iostream>
 #include <string>
 #include <glm/gtc/type_ptr.hpp>
 
 #include "file_utils.h"
 #include "shader.h"
+#include "render_state.h"
 
 namespace game {
 
@@ -16,15 +18,27 @@ Shader::Shader(void)
 }
 
 
-void Shader::Init(const char *vertPath, const char *fragPath)
+// Insert defines after the #version line, which must come first
+static std::string InsertDefines(const std::string &source, const std::string &defines)
+{
+    if (defines.empty()) return source;
+    size_t version = source.find("#version");
+    if (version == std::string::npos) return defines + source;
+    size_t line_end = source.find('\n', version);
+    if (line_end == std::string::npos) return source + "\n" + defines;
+    return source.substr(0, line_end + 1) + defines + source.substr(line_end + 1);
+}
+
+
+void Shader::Init(const char *vertPath, const char *fragPath, const std::string &defines)
 {
    
     // Load shader program source code
     // Vertex program
-    std::string vp = LoadTextFile(vertPath);
+    std::string vp = InsertDefines(LoadTextFile(vertPath), defines);
     const char *source_vp = vp.c_str();
     // Fragment program
-    std::string fp = LoadTextFile(fragPath);
+    std::string fp = InsertDefines(LoadTextFile(fragPath), defines);
     const char *source_fp = fp.c_str();
 
     // Create a shader from vertex program source code
@@ -73,75 +87,168 @@ void Shader::Init(const char *vertPath, const char *fragPath)
     // and linked
     glDeleteShader(vs);
     glDeleteShader(fs);
+
+    // Look up the uniform locations once, instead of on every set
+    ReflectUniforms();
 }
 
 
-void Shader::SetUniform1i(const GLchar *name, int value)
+void Shader::ReflectUniforms(void)
 {
+    uniforms_.clear();
+
+    GLint count = 0, max_length = 0;
+    glGetProgramiv(shader_program_, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(shader_program_, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+    std::vector<GLchar> buffer(max_length + 1);
+
+    for (GLint i = 0; i < count; i++) {
+        GLint size;
+        GLenum type;
+        glGetActiveUniform(shader_program_, i, (GLsizei)buffer.size(), NULL, &size, &type, &buffer[0]);
+
+        // Arrays are reported by their first element
+        std::string name(&buffer[0]);
+        size_t bracket = name.find('[');
+        if (bracket != std::string::npos) name.erase(bracket);
+
+        Uniform uniform;
+        uniform.name = name;
+        uniform.location = glGetUniformLocation(shader_program_, &buffer[0]);
+        uniform.has_value = false;
+        uniforms_.push_back(uniform);
+    }
+}
 
-    glUniform1i(glGetUniformLocation(shader_program_, name), value);
+
+UniformHandle Shader::GetUniform(const GLchar *name) const
+{
+    for (int i = 0; i < uniforms_.size(); i++) {
+        if (uniforms_[i].name == name) return UniformHandle(i);
+    }
+    return UniformHandle();
 }
 
 
-void Shader::SetUniform1f(const GLchar *name, float value)
+bool Shader::Changed(UniformHandle uniform, const void *data, size_t bytes)
 {
+    if (uniform.IsNull()) return false;
 
-    glUniform1f(glGetUniformLocation(shader_program_, name), value);
+    Uniform &u = uniforms_[uniform.index];
+    if (u.has_value && u.value.size() == bytes && memcmp(&u.value[0], data, bytes) == 0) {
+        return false;
+    }
+    const unsigned char *first = (const unsigned char *)data;
+    u.value.assign(first, first + bytes);
+    u.has_value = true;
+    return true;
 }
 
 
-void Shader::SetUniform2f(const GLchar *name, const glm::vec2 &vector)
+void Shader::SetUniform1i(UniformHandle uniform, int value)
 {
+    if (Changed(uniform, &value, sizeof(value))) glUniform1i(uniforms_[uniform.index].location, value);
+}
 
-    glUniform2f(glGetUniformLocation(shader_program_, name), vector.x, vector.y);
+
+void Shader::SetUniform1f(UniformHandle uniform, float value)
+{
+    if (Changed(uniform, &value, sizeof(value))) glUniform1f(uniforms_[uniform.index].location, value);
 }
 
 
-void Shader::SetUniform3f(const GLchar *name, const glm::vec3 &vector)
+void Shader::SetUniform2f(UniformHandle uniform, const glm::vec2 &vector)
 {
+    if (Changed(uniform, &vector, sizeof(vector))) glUniform2f(uniforms_[uniform.index].location, vector.x, vector.y);
+}
 
-    glUniform3f(glGetUniformLocation(shader_program_, name), vector.x, vector.y, vector.z);
+
+void Shader::SetUniform3f(UniformHandle uniform, const glm::vec3 &vector)
+{
+    if (Changed(uniform, &vector, sizeof(vector))) glUniform3f(uniforms_[uniform.index].location, vector.x, vector.y, vector.z);
 }
 
 
-void Shader::SetUniform4f(const GLchar *name, const glm::vec4 &vector)
+void Shader::SetUniform4f(UniformHandle uniform, const glm::vec4 &vector)
 {
+    if (Changed(uniform, &vector, sizeof(vector))) glUniform4f(uniforms_[uniform.index].location, vector.x, vector.y, vector.z, vector.w);
+}
+
 
-    glUniform4f(glGetUniformLocation(shader_program_, name), vector.x, vector.y, vector.z, vector.w);
+void Shader::SetUniformMat4(UniformHandle uniform, const glm::mat4 &matrix)
+{
+    if (Changed(uniform, glm::value_ptr(matrix), sizeof(matrix))) glUniformMatrix4fv(uniforms_[uniform.index].location, 1, GL_FALSE, glm::value_ptr(matrix));
 }
 
 
-void Shader::SetUniformMat4(const GLchar *name, const glm::mat4 &matrix)
+void Shader::SetUniformIntArray(UniformHandle uniform, int len, const GLint *data)
 {
+    if (len <= 0) return;
+    if (Changed(uniform, data, len * sizeof(GLint))) glUniform1iv(uniforms_[uniform.index].location, len, data);
+}
+
 
-    glUniformMatrix4fv(glGetUniformLocation(shader_program_, name), 1, GL_FALSE, glm::value_ptr(matrix));
+void Shader::SetUniform1i(const GLchar *name, int value)
+{
+    SetUniform1i(GetUniform(name), value);
 }
 
-void Shader::SetUniformIntArray(const GLchar* name, int len, const GLint* data)
+
+void Shader::SetUniform1f(const GLchar *name, float value)
+{
+    SetUniform1f(GetUniform(name), value);
+}
+
+
+void Shader::SetUniform2f(const GLchar *name, const glm::vec2 &vector)
+{
+    SetUniform2f(GetUniform(name), vector);
+}
+
+
+void Shader::SetUniform3f(const GLchar *name, const glm::vec3 &vector)
 {
+    SetUniform3f(GetUniform(name), vector);
+}
+
+
+void Shader::SetUniform4f(const GLchar *name, const glm::vec4 &vector)
+{
+    SetUniform4f(GetUniform(name), vector);
+}
+
 
-    glUniform1iv(glGetUniformLocation(shader_program_, name), len, data);
+void Shader::SetUniformMat4(const GLchar *name, const glm::mat4 &matrix)
+{
+    SetUniformMat4(GetUniform(name), matrix);
+}
+
+
+void Shader::SetUniformIntArray(const GLchar* name, int len, const GLint* data)
+{
+    SetUniformIntArray(GetUniform(name), len, data);
 }
 
 
 Shader::~Shader() 
 {
 
-    glDeleteProgram(shader_program_);
+    // Shaders are never initialized when running without a window
+    if (shader_program_ != 0) glDeleteProgram(shader_program_);
 }
 
 
 void Shader::Enable() 
 {
 
-    glUseProgram(shader_program_);
+    RenderState::UseProgram(shader_program_);
 }
 
 
 void Shader::Disable()
 {
 
-    glUseProgram(0);
+    RenderState::UseProgram(0);
 }
 
 } // namespace game
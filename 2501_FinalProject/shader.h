@@ -1,12 +1,26 @@
 #ifndef SHADER_H_
 #define SHADER_H_
 
+#include <string>
+#include <vector>
 #define GLEW_STATIC
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 
 namespace game {
 
+    // Refers to a uniform of one shader; get it once with
+    // Shader::GetUniform() instead of looking the name up on every set
+    // The null handle refers to no uniform and setting it does nothing
+    struct UniformHandle {
+        int index;
+
+        UniformHandle(void) : index(-1) {}
+        explicit UniformHandle(int i) : index(i) {}
+
+        inline bool IsNull(void) const { return index < 0; }
+    };
+
     // A class that stores a pair of vertex, fragment shaders
     class Shader {
 
@@ -15,12 +29,31 @@ namespace game {
             ~Shader();
 
             // Initialize shader with source files
-            void Init(const char *vertPath, const char *fragPath);
+            // Defines (lines of "#define NAME value") are inserted into both
+            // sources after the #version line, to make variants of a shader
+            void Init(const char *vertPath, const char *fragPath, const std::string &defines = std::string());
 
             // Enable or disable this specific shader
             void Enable();
             void Disable();
 
+            // Get the handle of an active uniform, null if the program has
+            // no such uniform (or the compiler removed it as unused)
+            UniformHandle GetUniform(const GLchar *name) const;
+
+            // Set uniforms by handle
+            // The shader must be enabled; values equal to the last value set
+            // are not uploaded again
+            void SetUniform1i(UniformHandle uniform, int value);
+            void SetUniform1f(UniformHandle uniform, float value);
+            void SetUniform2f(UniformHandle uniform, const glm::vec2 &vector);
+            void SetUniform3f(UniformHandle uniform, const glm::vec3 &vector);
+            void SetUniform4f(UniformHandle uniform, const glm::vec4 &vector);
+            void SetUniformMat4(UniformHandle uniform, const glm::mat4 &matrix);
+            void SetUniformIntArray(UniformHandle uniform, int len, const GLint *data);
+
+            // The setters below look the uniform up by name first
+
             // Sets a uniform integer variable in your shader program to a value
             void SetUniform1i(const GLchar *name, int value);
 
@@ -46,9 +79,26 @@ namespace game {
             inline GLuint GetShaderProgram(void) const { return shader_program_; }
 
         private:
+            // Active uniform of the program, with the last value set
+            struct Uniform {
+                std::string name;
+                GLint location;
+                std::vector<unsigned char> value;
+                bool has_value;
+            };
+
+            // Find the active uniforms of the linked program
+            void ReflectUniforms(void);
+
+            // Remember a new value for a uniform
+            // Returns false if it is the same as the last value set
+            bool Changed(UniformHandle uniform, const void *data, size_t bytes);
+
             // Reference to shader program
             GLuint shader_program_;
 
+            std::vector<Uniform> uniforms_;
+
     }; // class Shader
 } // namespace game
 
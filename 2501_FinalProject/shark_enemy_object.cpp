@@ -4,13 +4,12 @@
 
 namespace game {
 
-	SharkEnemyObject::SharkEnemyObject(const glm::vec3 &position, Geometry *geom, Shader *shader, GLuint texture, float yScale, float xScale, int health)
+	SharkEnemyObject::SharkEnemyObject(const glm::vec3 &position, Geometry *geom, Shader *shader, const TextureRegion &texture, float yScale, float xScale, int health)
 	: GameObject(position, geom, shader, texture, yScale, xScale, health) {
 
 	current_time_ = 0.0;
 	type_ = EnemyObj;
 	target_ = nullptr;
-	next_shot_ = 1.0;
 }
 
 // Generic mapping function
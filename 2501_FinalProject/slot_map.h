@@ -0,0 +1,198 @@
+#ifndef SLOT_MAP_H_
+#define SLOT_MAP_H_
+
+#include <vector>
+
+namespace game {
+
+    // A reference to a value stored in a SlotMap
+    // The generation tells apart values that reused the same slot, so a
+    // handle to a removed value never finds the value that replaced it
+    struct Handle {
+        unsigned int index;
+        unsigned int generation;
+
+        // The null handle: generation 0 is never used by a live value
+        Handle(void) : index(0), generation(0) {}
+
+        inline bool IsNull(void) const { return generation == 0; }
+        inline bool operator==(const Handle &other) const { return index == other.index && generation == other.generation; }
+        inline bool operator!=(const Handle &other) const { return !(*this == other); }
+    };
+
+    // Container with stable handles, O(1) insertion, lookup and removal,
+    // and values packed in one array for iteration
+    // Removing a value moves the last value into its place, so the order
+    // of iteration is not the order of insertion
+    template <typename T>
+    class SlotMap {
+
+        public:
+            SlotMap(void) {}
+
+            // Add a value and get the handle that refers to it
+            Handle Insert(const T &value);
+
+            // Remove the value a handle refers to
+            // Returns false if the handle is stale
+            bool Remove(const Handle &handle);
+
+            // Get the value a handle refers to, or nullptr if it was removed
+            T *Get(const Handle &handle);
+            const T *Get(const Handle &handle) const;
+
+            inline bool Contains(const Handle &handle) const { return Get(handle) != nullptr; }
+
+            // Remove all values; outstanding handles become stale
+            void Clear(void);
+
+            // Make room for count values, so inserting up to that many
+            // never reallocates
+            void Reserve(int count);
+
+            // Dense access, for iterating over all values
+            inline int Size(void) const { return (int)values_.size(); }
+            inline T &operator[](int i) { return values_[i]; }
+            inline const T &operator[](int i) const { return values_[i]; }
+
+            // Handle of the value at a dense index
+            Handle GetHandle(int i) const;
+
+            // Dense index of the value a handle refers to, -1 if it was
+            // removed
+            int GetIndex(const Handle &handle) const;
+
+        private:
+            struct Slot {
+                unsigned int generation;
+                // Position of the value in values_, or the next free slot
+                unsigned int dense_index;
+            };
+
+            // Marks the end of the free slot list
+            static const unsigned int no_slot_ = 0xffffffffu;
+
+            std::vector<Slot> slots_;
+            unsigned int free_head_ = no_slot_;
+
+            // Values, and the slot each one belongs to
+            std::vector<T> values_;
+            std::vector<unsigned int> value_slots_;
+
+    }; // class SlotMap
+
+
+    template <typename T>
+    Handle SlotMap<T>::Insert(const T &value)
+    {
+        unsigned int index;
+        if (free_head_ != no_slot_) {
+            index = free_head_;
+            free_head_ = slots_[index].dense_index;
+        }
+        else {
+            index = (unsigned int)slots_.size();
+            Slot slot;
+            slot.generation = 1;
+            slots_.push_back(slot);
+        }
+
+        slots_[index].dense_index = (unsigned int)values_.size();
+        values_.push_back(value);
+        value_slots_.push_back(index);
+
+        Handle handle;
+        handle.index = index;
+        handle.generation = slots_[index].generation;
+        return handle;
+    }
+
+
+    template <typename T>
+    void SlotMap<T>::Reserve(int count)
+    {
+        slots_.reserve(count);
+        values_.reserve(count);
+        value_slots_.reserve(count);
+    }
+
+
+    template <typename T>
+    bool SlotMap<T>::Remove(const Handle &handle)
+    {
+        if (Get(handle) == nullptr) {
+            return false;
+        }
+
+        // Fill the hole with the last value
+        unsigned int dense_index = slots_[handle.index].dense_index;
+        unsigned int last = (unsigned int)values_.size() - 1;
+        if (dense_index != last) {
+            values_[dense_index] = values_[last];
+            value_slots_[dense_index] = value_slots_[last];
+            slots_[value_slots_[dense_index]].dense_index = dense_index;
+        }
+        values_.pop_back();
+        value_slots_.pop_back();
+
+        // Invalidate the handles to this slot and reuse it later
+        Slot &slot = slots_[handle.index];
+        slot.generation++;
+        if (slot.generation == 0) slot.generation = 1;
+        slot.dense_index = free_head_;
+        free_head_ = handle.index;
+        return true;
+    }
+
+
+    template <typename T>
+    T *SlotMap<T>::Get(const Handle &handle)
+    {
+        if (handle.IsNull() || handle.index >= slots_.size() || slots_[handle.index].generation != handle.generation) {
+            return nullptr;
+        }
+        return &values_[slots_[handle.index].dense_index];
+    }
+
+
+    template <typename T>
+    const T *SlotMap<T>::Get(const Handle &handle) const
+    {
+        if (handle.IsNull() || handle.index >= slots_.size() || slots_[handle.index].generation != handle.generation) {
+            return nullptr;
+        }
+        return &values_[slots_[handle.index].dense_index];
+    }
+
+
+    template <typename T>
+    void SlotMap<T>::Clear(void)
+    {
+        while (!values_.empty()) {
+            Remove(GetHandle((int)values_.size() - 1));
+        }
+    }
+
+
+    template <typename T>
+    Handle SlotMap<T>::GetHandle(int i) const
+    {
+        Handle handle;
+        handle.index = value_slots_[i];
+        handle.generation = slots_[value_slots_[i]].generation;
+        return handle;
+    }
+
+
+    template <typename T>
+    int SlotMap<T>::GetIndex(const Handle &handle) const
+    {
+        if (Get(handle) == nullptr) {
+            return -1;
+        }
+        return (int)slots_[handle.index].dense_index;
+    }
+
+} // namespace game
+
+#endif // SLOT_MAP_H_
@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <cmath>
+
+#include "spatial_hash.h"
+
+namespace game {
+
+SpatialHash::SpatialHash(float cell_size, int num_buckets)
+{
+    cell_size_ = cell_size;
+    bucket_mask_ = num_buckets - 1;
+    bucket_start_.resize(num_buckets + 1, 0);
+    bucket_cursor_.resize(num_buckets, 0);
+}
+
+
+void SpatialHash::Clear(void)
+{
+    entries_.clear();
+}
+
+
+void SpatialHash::Reserve(int count)
+{
+    entries_.reserve(count);
+    sorted_ids_.reserve(count);
+}
+
+
+void SpatialHash::Insert(int id, const glm::vec3 &position, float radius)
+{
+    // Add the object to every cell its bounding box overlaps
+    int min_x = Cell(position.x - radius);
+    int max_x = Cell(position.x + radius);
+    int min_y = Cell(position.y - radius);
+    int max_y = Cell(position.y + radius);
+    for (int y = min_y; y <= max_y; y++) {
+        for (int x = min_x; x <= max_x; x++) {
+            Entry entry;
+            entry.bucket = Bucket(x, y);
+            entry.id = id;
+            entries_.push_back(entry);
+        }
+    }
+}
+
+
+void SpatialHash::Build(void)
+{
+    // Counting sort of the entries by bucket
+    std::fill(bucket_start_.begin(), bucket_start_.end(), 0);
+    for (int i = 0; i < entries_.size(); i++) {
+        bucket_start_[entries_[i].bucket + 1]++;
+    }
+    for (int i = 1; i < bucket_start_.size(); i++) {
+        bucket_start_[i] += bucket_start_[i - 1];
+    }
+
+    sorted_ids_.resize(entries_.size());
+    std::copy(bucket_start_.begin(), bucket_start_.end() - 1, bucket_cursor_.begin());
+    for (int i = 0; i < entries_.size(); i++) {
+        sorted_ids_[bucket_cursor_[entries_[i].bucket]++] = entries_[i].id;
+    }
+}
+
+
+void SpatialHash::QueryBox(const glm::vec2 &min, const glm::vec2 &max, std::vector<int> &result) const
+{
+    result.clear();
+    if (entries_.empty()) return;
+
+    int min_x = Cell(min.x);
+    int max_x = Cell(max.x);
+    int min_y = Cell(min.y);
+    int max_y = Cell(max.y);
+    for (int y = min_y; y <= max_y; y++) {
+        for (int x = min_x; x <= max_x; x++) {
+            unsigned int bucket = Bucket(x, y);
+            // Buckets can also hold other cells that hash to the same
+            // value; the caller's exact test filters those out
+            for (int i = bucket_start_[bucket]; i < bucket_start_[bucket + 1]; i++) {
+                result.push_back(sorted_ids_[i]);
+            }
+        }
+    }
+
+    // Return objects in the order they were added to the game, once each
+    // Sorting away the duplicates leaves the grid untouched, so threads
+    // can query it at the same time
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+}
+
+
+void SpatialHash::QuerySegment(const glm::vec3 &p0, const glm::vec3 &p1, float radius, std::vector<int> &result) const
+{
+    glm::vec2 min(std::min(p0.x, p1.x) - radius, std::min(p0.y, p1.y) - radius);
+    glm::vec2 max(std::max(p0.x, p1.x) + radius, std::max(p0.y, p1.y) + radius);
+    QueryBox(min, max, result);
+}
+
+
+void SpatialHash::QueryCircle(const glm::vec3 &center, float radius, std::vector<int> &result) const
+{
+    glm::vec2 min(center.x - radius, center.y - radius);
+    glm::vec2 max(center.x + radius, center.y + radius);
+    QueryBox(min, max, result);
+}
+
+} // namespace game
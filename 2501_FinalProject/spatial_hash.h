@@ -0,0 +1,75 @@
+#ifndef SPATIAL_HASH_H_
+#define SPATIAL_HASH_H_
+
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace game {
+
+    // A uniform grid over the game world, stored as a hash table of cells
+    // Used as a broad phase: it returns the objects that may be close to a
+    // point or segment, and the exact collision test is done by the caller
+    class SpatialHash {
+
+        public:
+            // cell_size is in world units, num_buckets must be a power of two
+            SpatialHash(float cell_size, int num_buckets);
+
+            // Remove all objects, keeping the allocated memory
+            void Clear(void);
+
+            // Make room for objects covering count cells in all, so
+            // inserting and building never reallocate
+            void Reserve(int count);
+
+            // Add object id, covering a circle of the given radius
+            void Insert(int id, const glm::vec3 &position, float radius);
+
+            // Sort the inserted objects into cells
+            // Call after inserting and before querying
+            void Build(void);
+
+            // Get the ids of objects in the cells overlapping a box, in
+            // increasing order and without duplicates
+            // Queries don't change the grid, so threads can share it
+            void QueryBox(const glm::vec2 &min, const glm::vec2 &max, std::vector<int> &result) const;
+
+            // Get the objects in the cells around the segment p0-p1, widened
+            // by radius (a bullet's segment for one step is short, so this
+            // covers only a few cells)
+            void QuerySegment(const glm::vec3 &p0, const glm::vec3 &p1, float radius, std::vector<int> &result) const;
+
+            // Get the objects in the cells overlapping a circle
+            void QueryCircle(const glm::vec3 &center, float radius, std::vector<int> &result) const;
+
+        private:
+            // An object covering one cell
+            struct Entry {
+                unsigned int bucket;
+                int id;
+            };
+
+            // Cell coordinate of a world coordinate
+            inline int Cell(float value) const { return (int)floor(value / cell_size_); }
+
+            // Bucket of the hash table holding a cell
+            inline unsigned int Bucket(int x, int y) const {
+                return (((unsigned int)x * 73856093u) ^ ((unsigned int)y * 19349663u)) & bucket_mask_;
+            }
+
+            float cell_size_;
+            unsigned int bucket_mask_;
+
+            // Objects added since the last Clear(), one entry per cell
+            std::vector<Entry> entries_;
+
+            // Object ids sorted by bucket, and where each bucket starts
+            std::vector<int> sorted_ids_;
+            std::vector<int> bucket_start_;
+            std::vector<int> bucket_cursor_;
+
+    }; // class SpatialHash
+
+} // namespace game
+
+#endif // SPATIAL_HASH_H_
@@ -3,6 +3,7 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include "sprite.h"
+#include "render_state.h"
 
 namespace game {
 
@@ -57,13 +58,16 @@ void Sprite::SetGeometry(GLuint shader_program)
 {
 
     // No blending
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
-    glDisable(GL_BLEND);
+    RenderState::SetDepthTest(true, GL_LESS);
+    RenderState::SetBlend(false);
 
-    // Bind buffers
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
+    // Bind the buffers and attributes set up for this shader
+    BindVertexArray(shader_program);
+}
+
+
+void Sprite::SetAttributes(GLuint shader_program)
+{
 
     // Set attributes for shaders
     // Should be consistent with how we created the buffers for the square
@@ -18,6 +18,10 @@ namespace game {
             // Use the geometry
             void SetGeometry(GLuint shader_program);
 
+        protected:
+            // Set up the attributes of a shader program (called once per program)
+            void SetAttributes(GLuint shader_program);
+
     }; // class Sprite
 } // namespace game
 
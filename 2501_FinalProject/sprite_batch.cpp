@@ -0,0 +1,287 @@
+#include <cstddef>
+#include <cstring>
+
+#include "sprite_batch.h"
+#include "render_state.h"
+
+namespace game {
+
+// Depth added for every sprite drawn before, so earlier sprites stay in
+// front; small enough that thousands of sprites stay within the gap
+// between layers (text is at -1, turrets at -0.5)
+const float sprite_depth_step_g = 1.0e-5f;
+
+// Floats per quad corner: corner position (2) and texture coordinates (2)
+const int corner_floats_g = 4;
+
+
+// Point an attribute at the bound array buffer, skipping attributes the
+// shader compiler removed
+static void EnableAttribute(GLint location, GLint size, GLsizei stride, size_t offset)
+{
+    if (location < 0) return;
+    glVertexAttribPointer(location, size, GL_FLOAT, GL_FALSE, stride, (void *)offset);
+    glEnableVertexAttribArray(location);
+}
+
+
+SpriteBatch::SpriteBatch(void)
+{
+    // Don't do work in the constructor, leave it for the Init() function
+    shader_ = nullptr;
+    view_matrix_ = glm::mat4(1.0f);
+    instancing_ = false;
+    last_group_ = -1;
+    num_sprites_ = 0;
+    num_draws_ = 0;
+    vertex_array_ = 0;
+    quad_vbo_ = 0;
+    quad_ebo_ = 0;
+    stream_vbo_ = 0;
+    stream_ebo_ = 0;
+    stream_quads_ = 0;
+    vertex_att_ = uv_att_ = position_att_ = size_att_ = angle_att_ = uv_rect_att_ = tint_att_ = -1;
+}
+
+
+void SpriteBatch::Init(Shader *shader)
+{
+    shader_ = shader;
+
+    // Instanced attributes are core in OpenGL 3.3
+#ifdef SPRITE_BATCH_NO_INSTANCING
+    instancing_ = false;
+#else
+    instancing_ = GLEW_VERSION_3_3 ? true : false;
+#endif
+
+    view_matrix_uniform_ = shader_->GetUniform("view_matrix");
+
+    GLuint program = shader_->GetShaderProgram();
+    vertex_att_ = glGetAttribLocation(program, "vertex");
+    uv_att_ = glGetAttribLocation(program, "uv");
+    position_att_ = glGetAttribLocation(program, "sprite_position");
+    size_att_ = glGetAttribLocation(program, "sprite_size");
+    angle_att_ = glGetAttribLocation(program, "sprite_angle");
+    uv_rect_att_ = glGetAttribLocation(program, "sprite_uv_rect");
+    tint_att_ = glGetAttribLocation(program, "sprite_tint");
+
+    // Same square as the Sprite geometry
+    GLfloat corners[] = {
+        // Position      Texture coordinates
+        -0.5f,  0.5f,    0.0f, 0.0f, // Top-left
+         0.5f,  0.5f,    1.0f, 0.0f, // Top-right
+         0.5f, -0.5f,    1.0f, 1.0f, // Bottom-right
+        -0.5f, -0.5f,    0.0f, 1.0f  // Bottom-left
+    };
+    GLuint face[] = {
+        0, 1, 2, // t1
+        2, 3, 0  // t2
+    };
+
+    glGenBuffers(1, &quad_vbo_);
+    glBindBuffer(GL_ARRAY_BUFFER, quad_vbo_);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+
+    glGenBuffers(1, &quad_ebo_);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quad_ebo_);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(face), face, GL_STATIC_DRAW);
+
+    glGenBuffers(1, &stream_vbo_);
+    glGenBuffers(1, &stream_ebo_);
+
+    // Set up the attributes that stay the same from frame to frame
+    glGenVertexArrays(1, &vertex_array_);
+    RenderState::BindVertexArray(vertex_array_);
+    if (instancing_) {
+        // Every instance reads the corners of the unit quad
+        glBindBuffer(GL_ARRAY_BUFFER, quad_vbo_);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quad_ebo_);
+        EnableAttribute(vertex_att_, 2, corner_floats_g * sizeof(GLfloat), 0);
+        EnableAttribute(uv_att_, 2, corner_floats_g * sizeof(GLfloat), 2 * sizeof(GLfloat));
+
+        // The rest advances once per instance
+        GLint atts[] = { position_att_, size_att_, angle_att_, uv_rect_att_, tint_att_ };
+        for (int i = 0; i < 5; i++) {
+            if (atts[i] >= 0) glVertexAttribDivisor(atts[i], 1);
+        }
+    }
+    else {
+        // Every corner carries all attributes; the buffer is refilled each
+        // frame, but the layout doesn't change
+        const int instance_floats = sizeof(Instance) / sizeof(float);
+        GLsizei stride = (corner_floats_g + instance_floats) * sizeof(GLfloat);
+        glBindBuffer(GL_ARRAY_BUFFER, stream_vbo_);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, stream_ebo_);
+        EnableAttribute(vertex_att_, 2, stride, 0);
+        EnableAttribute(uv_att_, 2, stride, 2 * sizeof(GLfloat));
+        SetInstanceAttributes(stride, corner_floats_g * sizeof(GLfloat));
+    }
+
+    // Unbind, so buffers bound later don't end up in this vertex array
+    RenderState::BindVertexArray(0);
+}
+
+
+void SpriteBatch::Begin(const glm::mat4 &view_matrix)
+{
+    view_matrix_ = view_matrix;
+    for (int i = 0; i < groups_.size(); i++) {
+        groups_[i].instances.clear();
+    }
+    num_sprites_ = 0;
+}
+
+
+void SpriteBatch::Add(GLuint texture, const glm::vec3 &position, const glm::vec2 &size, float angle, const glm::vec4 &uv_rect, const glm::vec4 &tint)
+{
+    // Find the group of the texture; groups are kept between frames
+    if (last_group_ < 0 || groups_[last_group_].texture != texture) {
+        last_group_ = -1;
+        for (int i = 0; i < groups_.size(); i++) {
+            if (groups_[i].texture == texture) {
+                last_group_ = i;
+                break;
+            }
+        }
+        if (last_group_ < 0) {
+            Group group;
+            group.texture = texture;
+            groups_.push_back(group);
+            last_group_ = (int)groups_.size() - 1;
+        }
+    }
+
+    Instance instance;
+    instance.position[0] = position.x;
+    instance.position[1] = position.y;
+    instance.position[2] = position.z + num_sprites_ * sprite_depth_step_g;
+    instance.size[0] = size.x;
+    instance.size[1] = size.y;
+    instance.angle = angle;
+    for (int i = 0; i < 4; i++) {
+        instance.uv_rect[i] = uv_rect[i];
+        instance.tint[i] = tint[i];
+    }
+    groups_[last_group_].instances.push_back(instance);
+    num_sprites_++;
+}
+
+
+void SpriteBatch::SetInstanceAttributes(GLsizei stride, size_t offset)
+{
+    EnableAttribute(position_att_, 3, stride, offset + offsetof(Instance, position));
+    EnableAttribute(size_att_, 2, stride, offset + offsetof(Instance, size));
+    EnableAttribute(angle_att_, 1, stride, offset + offsetof(Instance, angle));
+    EnableAttribute(uv_rect_att_, 4, stride, offset + offsetof(Instance, uv_rect));
+    EnableAttribute(tint_att_, 4, stride, offset + offsetof(Instance, tint));
+}
+
+
+void SpriteBatch::ReserveQuads(int count)
+{
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, stream_ebo_);
+    if (count <= stream_quads_) return;
+
+    // Grow in powers of two so the indices are rarely rebuilt
+    int quads = stream_quads_ > 0 ? stream_quads_ : 256;
+    while (quads < count) quads *= 2;
+
+    std::vector<GLuint> face(quads * 6);
+    for (int i = 0; i < quads; i++) {
+        GLuint corner = i * 4;
+        face[i * 6 + 0] = corner + 0;
+        face[i * 6 + 1] = corner + 1;
+        face[i * 6 + 2] = corner + 2;
+        face[i * 6 + 3] = corner + 2;
+        face[i * 6 + 4] = corner + 3;
+        face[i * 6 + 5] = corner + 0;
+    }
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, face.size() * sizeof(GLuint), &face[0], GL_STATIC_DRAW);
+    stream_quads_ = quads;
+}
+
+
+void SpriteBatch::Flush(void)
+{
+    num_draws_ = 0;
+    if (num_sprites_ == 0) return;
+
+    // No blending
+    RenderState::SetDepthTest(true, GL_LESS);
+    RenderState::SetBlend(false);
+
+    shader_->Enable();
+    shader_->SetUniformMat4(view_matrix_uniform_, view_matrix_);
+    RenderState::BindVertexArray(vertex_array_);
+
+    const int instance_floats = sizeof(Instance) / sizeof(float);
+
+    if (instancing_) {
+
+        // Upload all instances at once, grouped by texture
+        vertices_.resize(num_sprites_ * instance_floats);
+        float *out = vertices_.data();
+        for (int i = 0; i < groups_.size(); i++) {
+            size_t bytes = groups_[i].instances.size() * sizeof(Instance);
+            if (bytes == 0) continue;
+            memcpy(out, groups_[i].instances.data(), bytes);
+            out += bytes / sizeof(float);
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, stream_vbo_);
+        glBufferData(GL_ARRAY_BUFFER, vertices_.size() * sizeof(float), vertices_.data(), GL_STREAM_DRAW);
+
+        // One instanced draw per texture
+        size_t first = 0;
+        for (int i = 0; i < groups_.size(); i++) {
+            int count = (int)groups_[i].instances.size();
+            if (count == 0) continue;
+            SetInstanceAttributes(sizeof(Instance), first * sizeof(Instance));
+            RenderState::BindTexture(groups_[i].texture);
+            glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, count);
+            first += count;
+            num_draws_++;
+        }
+    }
+    else {
+
+        // Expand every sprite to four corners carrying its instance data
+        static const float corners[4][corner_floats_g] = {
+            { -0.5f,  0.5f, 0.0f, 0.0f },
+            {  0.5f,  0.5f, 1.0f, 0.0f },
+            {  0.5f, -0.5f, 1.0f, 1.0f },
+            { -0.5f, -0.5f, 0.0f, 1.0f }
+        };
+        const int vertex_floats = corner_floats_g + instance_floats;
+        vertices_.resize(num_sprites_ * 4 * vertex_floats);
+        float *out = vertices_.data();
+        for (int i = 0; i < groups_.size(); i++) {
+            const std::vector<Instance> &instances = groups_[i].instances;
+            for (int j = 0; j < instances.size(); j++) {
+                for (int k = 0; k < 4; k++) {
+                    memcpy(out, corners[k], sizeof(corners[k]));
+                    memcpy(out + corner_floats_g, &instances[j], sizeof(Instance));
+                    out += vertex_floats;
+                }
+            }
+        }
+
+        ReserveQuads(num_sprites_);
+        glBindBuffer(GL_ARRAY_BUFFER, stream_vbo_);
+        glBufferData(GL_ARRAY_BUFFER, vertices_.size() * sizeof(float), vertices_.data(), GL_STREAM_DRAW);
+
+        // One draw per texture over its range of quads
+        size_t first = 0;
+        for (int i = 0; i < groups_.size(); i++) {
+            int count = (int)groups_[i].instances.size();
+            if (count == 0) continue;
+            RenderState::BindTexture(groups_[i].texture);
+            glDrawElements(GL_TRIANGLES, count * 6, GL_UNSIGNED_INT, (void *)(first * 6 * sizeof(GLuint)));
+            first += count;
+            num_draws_++;
+        }
+    }
+}
+
+} // namespace game
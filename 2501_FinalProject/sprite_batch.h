@@ -0,0 +1,102 @@
+#ifndef SPRITE_BATCH_H_
+#define SPRITE_BATCH_H_
+
+#include <vector>
+#include <glm/glm.hpp>
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+#include "shader.h"
+
+namespace game {
+
+    // Collects the sprites of a frame and draws them with one draw call per
+    // texture instead of one per sprite
+    // Sprites are instanced when the GPU supports it (OpenGL 3.3), otherwise
+    // their quads are built on the CPU and drawn from one vertex buffer
+    class SpriteBatch {
+
+        public:
+            SpriteBatch(void);
+
+            // Create the buffers; the shader is used for every sprite
+            void Init(Shader *shader);
+
+            // Start a new frame of sprites
+            void Begin(const glm::mat4 &view_matrix);
+
+            // Add a sprite; uv_rect is the offset (xy) and size (zw) of the
+            // part of the texture that is drawn
+            // Sprites drawn earlier in a frame are drawn in front of later
+            // sprites at the same depth
+            void Add(GLuint texture, const glm::vec3 &position, const glm::vec2 &size, float angle,
+                const glm::vec4 &uv_rect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), const glm::vec4 &tint = glm::vec4(1.0f));
+
+            // Draw all sprites added since Begin()
+            void Flush(void);
+
+            inline const glm::mat4 &GetViewMatrix(void) const { return view_matrix_; }
+            inline bool GetInstancing(void) const { return instancing_; }
+
+            // Draw calls issued by the last Flush()
+            inline int GetNumDraws(void) const { return num_draws_; }
+
+        private:
+            // Per-sprite data, read once per sprite when instancing
+            struct Instance {
+                float position[3];
+                float size[2];
+                float angle;
+                float uv_rect[4];
+                float tint[4];
+            };
+
+            // Sprites that share a texture
+            struct Group {
+                GLuint texture;
+                std::vector<Instance> instances;
+            };
+
+            // Point the instance attributes at an offset in the bound buffer
+            void SetInstanceAttributes(GLsizei stride, size_t offset);
+
+            // Index buffer large enough for count quads
+            void ReserveQuads(int count);
+
+            Shader *shader_;
+            UniformHandle view_matrix_uniform_;
+            glm::mat4 view_matrix_;
+            bool instancing_;
+
+            std::vector<Group> groups_;
+            // Group that received the last sprite, most sprites come in runs
+            int last_group_;
+            int num_sprites_;
+            int num_draws_;
+
+            // Buffers and attributes of the batch, kept apart from the
+            // vertex arrays of the other geometry
+            GLuint vertex_array_;
+            // Corners of the unit quad
+            GLuint quad_vbo_;
+            GLuint quad_ebo_;
+            // Instances, or expanded quads without instancing
+            GLuint stream_vbo_;
+            GLuint stream_ebo_;
+            int stream_quads_;
+            std::vector<float> vertices_;
+
+            // Attribute locations in the shader
+            GLint vertex_att_;
+            GLint uv_att_;
+            GLint position_att_;
+            GLint size_att_;
+            GLint angle_att_;
+            GLint uv_rect_att_;
+            GLint tint_att_;
+
+    }; // class SpriteBatch
+
+} // namespace game
+
+#endif // SPRITE_BATCH_H_
@@ -0,0 +1,35 @@
+// Source code of vertex shader
+#version 130
+
+// Corner of the unit square
+in vec2 vertex;
+in vec2 uv;
+
+// Sprite the corner belongs to
+in vec3 sprite_position;
+in vec2 sprite_size;
+in float sprite_angle;
+in vec4 sprite_uv_rect;
+in vec4 sprite_tint;
+
+// Uniform (global) buffer
+uniform mat4 view_matrix;
+
+// Attributes forwarded to the fragment shader
+out vec4 color_interp;
+out vec2 uv_interp;
+
+void main()
+{
+    // Scale, rotate and translate the corner
+    vec2 scaled = vertex * sprite_size;
+    float c = cos(sprite_angle);
+    float s = sin(sprite_angle);
+    vec2 rotated = vec2(c*scaled.x - s*scaled.y, s*scaled.x + c*scaled.y);
+    vec4 vertex_pos = vec4(rotated + sprite_position.xy, sprite_position.z, 1.0);
+    gl_Position = view_matrix * vertex_pos;
+
+    // Pass attributes to fragment shader
+    color_interp = sprite_tint;
+    uv_interp = sprite_uv_rect.xy + uv * sprite_uv_rect.zw;
+}
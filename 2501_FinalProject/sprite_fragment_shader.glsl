@@ -11,7 +11,7 @@ uniform sampler2D onetex;
 void main()
 {
     // Sample texture
-    vec4 color = texture2D(onetex, uv_interp);
+    vec4 color = texture2D(onetex, uv_interp) * color_interp;
 
     // Assign color to fragment
     gl_FragColor = vec4(color.r, color.g, color.b, color.a);
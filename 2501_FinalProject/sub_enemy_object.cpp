@@ -4,7 +4,7 @@
 
 namespace game {
 
-	SubEnemyObject::SubEnemyObject(const glm::vec3 &position, Geometry *geom, Shader *shader, GLuint texture, float yScale, float xScale, int health)
+	SubEnemyObject::SubEnemyObject(const glm::vec3 &position, Geometry *geom, Shader *shader, const TextureRegion &texture, float yScale, float xScale, int health)
 	: GameObject(position, geom, shader, texture, yScale, xScale, health) {
 
 	target_ = nullptr;
@@ -13,7 +13,6 @@ namespace game {
 	type_ = EnemyObj;
 	docile_ = true;
 	lastSecond_ = 0;
-	next_shot_ = 3.0;
 }
 
 // Generic mapping function
@@ -1,75 +1,73 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "text_game_object.h"
+#include "render_snapshot.h"
+#include "object_pool.h"
 
 namespace game {
 
-TextGameObject::TextGameObject(const glm::vec3 &position, Geometry *geom, Shader *shader, GLuint texture, float yScale, float xScale, int health) 
+TextGameObject::TextGameObject(const glm::vec3 &position, Geometry *geom, Shader *shader, const TextureRegion &texture, float yScale, float xScale, int health) 
     : GameObject(position, geom, shader, texture, yScale, xScale, health) {
 
-    text_ = "";
+    text_[0] = '\0';
+    text_length_ = 0;
 }
 
 
-void TextGameObject::Render(glm::mat4 view_matrix, double current_time) {
-
-    // Set up the shader
-    shader_->Enable();
-
-    // Set up the view matrix
-    shader_->SetUniformMat4("view_matrix", view_matrix);
+// Pool shared by all text objects
+static ObjectPool &TextGameObjectPool(void) {
+    static ObjectPool pool(sizeof(TextGameObject), 32);
+    return pool;
+}
 
-    // Setup the scaling matrix for the shader
-    glm::mat4 scaling_matrix = glm::scale(glm::mat4(1.0f), glm::vec3(scale_ * xScale_, scale_ * yScale_, 1.0f));
 
-    // Setup the rotation matrix for the shader
-    glm::mat4 rotation_matrix = glm::rotate(glm::mat4(1.0f), angle_, glm::vec3(0.0, 0.0, 1.0));
+void *TextGameObject::operator new(std::size_t size) {
+    if (size != sizeof(TextGameObject)) return ::operator new(size);
+    return TextGameObjectPool().Allocate();
+}
 
-    // Set up the translation matrix for the shader
-    glm::mat4 translation_matrix = glm::translate(glm::mat4(1.0f), position_);
 
-    // Setup the transformation matrix for the shader
-    glm::mat4 transformation_matrix = translation_matrix * rotation_matrix * scaling_matrix;
+void TextGameObject::operator delete(void *block, std::size_t size) {
+    if (size != sizeof(TextGameObject)) {
+        ::operator delete(block);
+        return;
+    }
+    TextGameObjectPool().Free(block);
+}
 
-    // Set the transformation matrix in the shader
-    shader_->SetUniformMat4("transformation_matrix", transformation_matrix);
 
-    // Set up the geometry
-    geometry_->SetGeometry(shader_->GetShaderProgram());
+void TextGameObject::Snapshot(RenderSnapshot &snapshot) const {
 
-    // Bind the entity's texture
-    glBindTexture(GL_TEXTURE_2D, texture_);
+    GameObject::Snapshot(snapshot);
+    DrawRecord &record = snapshot.records.back();
+    record.kind = TextDraw;
+    record.text_start = (int)snapshot.text.size();
+    record.text_length = text_length_;
+    snapshot.text.insert(snapshot.text.end(), text_, text_ + text_length_);
+}
 
-    // Set the text
-#define TEXT_LENGTH 40
-    // Set text length
-    int final_size = text_.size();
-    if (final_size > TEXT_LENGTH){
-        final_size = TEXT_LENGTH;
-    }
-    shader_->SetUniform1i("text_len", final_size);
 
-    // Set the text data
-    GLint data[TEXT_LENGTH];
-    for (int i = 0; i < final_size; i++){
-        data[i] = text_[i];
-    }
-    shader_->SetUniformIntArray("text_content", final_size, data);
+std::string TextGameObject::GetText(void) const {
 
-    // Draw the entity
-    glDrawElements(GL_TRIANGLES, geometry_->GetSize(), GL_UNSIGNED_INT, 0);
+    return std::string(text_, text_length_);
 }
 
 
-std::string TextGameObject::GetText(void) const {
+void TextGameObject::SetText(const std::string &text){
 
-    return text_;
+    SetText(text.c_str());
 }
 
 
-void TextGameObject::SetText(std::string text){
+void TextGameObject::SetText(const char *text){
 
-    text_ = text;
+    int length = 0;
+    while (length < TEXT_LENGTH && text[length] != '\0') {
+        text_[length] = text[length];
+        length++;
+    }
+    text_[length] = '\0';
+    text_length_ = length;
 }
 
 } // namespace game
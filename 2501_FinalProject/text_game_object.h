@@ -1,27 +1,40 @@
 #ifndef TEXT_GAME_OBJECT_H_
 #define TEXT_GAME_OBJECT_H_
 
+#include <cstddef>
 #include <string>
 
 #include "game_object.h"
 
+// Most characters the text shader can draw
+#define TEXT_LENGTH 40
+
 namespace game {
 
     // Inherits from GameObject
     class TextGameObject : public GameObject {
 
         public:
-            TextGameObject(const glm::vec3 &position, Geometry *geom, Shader *shader, GLuint texture, float yScale, float xScale, int health);
+            TextGameObject(const glm::vec3 &position, Geometry *geom, Shader *shader, const TextureRegion &texture, float yScale, float xScale, int health);
 
             // Text to be displayed
             std::string GetText(void) const;
-            void SetText(std::string text);
+            // Text longer than TEXT_LENGTH is cut off
+            void SetText(const std::string &text);
+            void SetText(const char *text);
+
+            // Drawn with its own shader, which writes out the text
+            void Snapshot(RenderSnapshot &snapshot) const override;
 
-            // Render function for the text
-            void Render(glm::mat4 view_matrix, double current_time) override;
+            // Text objects are allocated from a pool, since one is made for
+            // every message shown during the game
+            static void *operator new(std::size_t size);
+            static void operator delete(void *block, std::size_t size);
 
         private:
-            std::string text_;
+            // Stored in place, so changing the text does not allocate
+            char text_[TEXT_LENGTH + 1];
+            int text_length_;
 
     }; // class TextGameObject
 
@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "texture_atlas.h"
+
+namespace game {
+
+TextureAtlas::TextureAtlas(int page_size, int padding)
+{
+    page_size_ = page_size;
+    padding_ = padding;
+}
+
+
+int TextureAtlas::Add(const unsigned char *pixels, int width, int height)
+{
+    Image image;
+    image.width = width;
+    image.height = height;
+    image.pixels.assign(pixels, pixels + width * height * 4);
+    image.page = -1;
+    image.x = 0;
+    image.y = 0;
+    images_.push_back(image);
+    regions_.push_back(TextureRegion());
+    return (int)images_.size() - 1;
+}
+
+
+void TextureAtlas::Build(void)
+{
+    // Pages can't be larger than the GPU allows
+    GLint max_size = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+    if (max_size > 0 && page_size_ > max_size) page_size_ = max_size;
+
+    // Pack on shelves, tallest images first so each shelf wastes little
+    std::vector<int> order(images_.size());
+    for (int i = 0; i < order.size(); i++) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+        return images_[a].height > images_[b].height;
+    });
+
+    int num_pages = images_.empty() ? 0 : 1;
+    int shelf_x = 0, shelf_y = 0, shelf_height = 0;
+    for (int i = 0; i < order.size(); i++) {
+        Image &image = images_[order[i]];
+        int width = image.width + 2 * padding_;
+        int height = image.height + 2 * padding_;
+        if (width > page_size_ || height > page_size_) {
+            throw(std::runtime_error(std::string("Image too large for the texture atlas: ") + std::to_string(image.width) + "x" + std::to_string(image.height)));
+        }
+
+        // Start a new shelf, or a new page, when the image doesn't fit
+        if (shelf_x + width > page_size_) {
+            shelf_x = 0;
+            shelf_y += shelf_height;
+            shelf_height = 0;
+        }
+        if (shelf_y + height > page_size_) {
+            num_pages++;
+            shelf_x = shelf_y = shelf_height = 0;
+        }
+
+        image.page = num_pages - 1;
+        image.x = shelf_x + padding_;
+        image.y = shelf_y + padding_;
+        shelf_x += width;
+        shelf_height = std::max(shelf_height, height);
+    }
+
+    // Fill and upload the pages
+    std::vector<unsigned char> pixels;
+    for (int page = 0; page < num_pages; page++) {
+        pixels.assign(page_size_ * page_size_ * 4, 0);
+        for (int i = 0; i < images_.size(); i++) {
+            if (images_[i].page == page) CopyToPage(images_[i], pixels);
+        }
+
+        GLuint texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, page_size_, page_size_, 0, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        pages_.push_back(texture);
+    }
+
+    // Hand out the regions and drop the copies of the pixels
+    float size = (float)page_size_;
+    for (int i = 0; i < images_.size(); i++) {
+        Image &image = images_[i];
+        regions_[i].texture = pages_[image.page];
+        regions_[i].uv_rect = glm::vec4(image.x / size, image.y / size, image.width / size, image.height / size);
+        std::vector<unsigned char>().swap(image.pixels);
+    }
+}
+
+
+void TextureAtlas::CopyToPage(const Image &image, std::vector<unsigned char> &page) const
+{
+    // Every pixel of the padded rectangle takes the nearest image pixel
+    for (int y = -padding_; y < image.height + padding_; y++) {
+        int source_y = std::min(std::max(y, 0), image.height - 1);
+        for (int x = -padding_; x < image.width + padding_; x++) {
+            int source_x = std::min(std::max(x, 0), image.width - 1);
+            const unsigned char *source = &image.pixels[(source_y * image.width + source_x) * 4];
+            unsigned char *target = &page[((image.y + y) * page_size_ + image.x + x) * 4];
+            for (int c = 0; c < 4; c++) target[c] = source[c];
+        }
+    }
+}
+
+} // namespace game
@@ -0,0 +1,66 @@
+#ifndef TEXTURE_ATLAS_H_
+#define TEXTURE_ATLAS_H_
+
+#include <vector>
+#include <glm/glm.hpp>
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+namespace game {
+
+    // Part of a texture: offset (xy) and size (zw) in texture coordinates
+    struct TextureRegion {
+        GLuint texture;
+        glm::vec4 uv_rect;
+
+        // The whole of a texture
+        TextureRegion(GLuint tex = 0) : texture(tex), uv_rect(0.0f, 0.0f, 1.0f, 1.0f) {}
+    };
+
+    // Packs images into a few large textures (pages), so sprites with
+    // different images can be drawn with the same texture bound
+    class TextureAtlas {
+
+        public:
+            // Pages are square; padding is the border kept around every image
+            TextureAtlas(int page_size = 2048, int padding = 2);
+
+            // Add an RGBA image and get the index of its region
+            // The pixels are copied
+            int Add(const unsigned char *pixels, int width, int height);
+
+            // Pack all images added so far into pages and upload them
+            // Throws if an image does not fit in a page
+            void Build(void);
+
+            // Region of an image, valid after Build()
+            inline const TextureRegion &GetRegion(int index) const { return regions_[index]; }
+            inline int GetNumPages(void) const { return (int)pages_.size(); }
+
+        private:
+            struct Image {
+                int width;
+                int height;
+                std::vector<unsigned char> pixels;
+                // Page and position of the top-left pixel once packed
+                int page;
+                int x;
+                int y;
+            };
+
+            // Copy an image into its page, repeating its edge pixels into
+            // the padding so filtering at the edges does not pick up the
+            // neighbouring images
+            void CopyToPage(const Image &image, std::vector<unsigned char> &page) const;
+
+            int page_size_;
+            int padding_;
+            std::vector<Image> images_;
+            std::vector<TextureRegion> regions_;
+            std::vector<GLuint> pages_;
+
+    }; // class TextureAtlas
+
+} // namespace game
+
+#endif // TEXTURE_ATLAS_H_
@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <cmath>
+
+#include "timer_wheel.h"
+
+namespace game {
+
+TimerWheel::TimerWheel(void)
+{
+    // Don't do work in the constructor, leave it for the Init() function
+    clock_ = nullptr;
+    tick_length_ = 1.0;
+    now_ = 0;
+}
+
+
+void TimerWheel::Init(const Clock *clock, double tick_length)
+{
+    clock_ = clock;
+    tick_length_ = tick_length;
+    Clear();
+    now_ = (long long)std::floor(clock_->GetTime() / tick_length_ + 0.5);
+}
+
+
+Handle TimerWheel::Start(double delay, const TimerEvent &event)
+{
+    // Delays that are whole ticks must not round up to the next tick
+    // through floating point error
+    long long ticks = (long long)std::ceil(delay / tick_length_ - 1.0e-3);
+    if (ticks < 1) ticks = 1;
+
+    Timer timer;
+    timer.event = event;
+    timer.expiry = now_ + ticks;
+    timer.slot = 0;
+    Handle handle = timers_.Insert(timer);
+    Insert(handle, *timers_.Get(handle));
+    return handle;
+}
+
+
+bool TimerWheel::Cancel(const Handle &timer)
+{
+    Timer *running = timers_.Get(timer);
+    if (running == nullptr) return false;
+    Unlink(*running);
+    timers_.Remove(timer);
+    return true;
+}
+
+
+void TimerWheel::Advance(std::vector<TimerEvent> &expired)
+{
+    long long target = (long long)std::floor(clock_->GetTime() / tick_length_ + 0.5);
+    while (now_ < target) {
+        Tick(expired);
+    }
+}
+
+
+void TimerWheel::Clear(void)
+{
+    timers_.Clear();
+    for (int slot = 0; slot < num_levels_ * num_slots_; slot++) {
+        heads_[slot] = Handle();
+        tails_[slot] = Handle();
+    }
+}
+
+
+void TimerWheel::Reserve(int count)
+{
+    timers_.Reserve(count);
+}
+
+
+void TimerWheel::Insert(const Handle &handle, Timer &timer)
+{
+    // Timers beyond the top level wait in its last slot and are put back
+    // each time it comes up
+    const long long span = 1LL << (slot_bits_ * num_levels_);
+    long long at = std::min(timer.expiry, now_ + span - 1);
+
+    // The lowest level whose span reaches the expiry
+    int level = 0;
+    while (level < num_levels_ - 1 && at - now_ >= (1LL << (slot_bits_ * (level + 1)))) {
+        level++;
+    }
+    int slot = level * num_slots_ + (int)((at >> (slot_bits_ * level)) & (num_slots_ - 1));
+
+    // Append, so timers of the same tick expire in the order they started
+    timer.slot = slot;
+    timer.previous = tails_[slot];
+    timer.next = Handle();
+    if (tails_[slot].IsNull()) {
+        heads_[slot] = handle;
+    }
+    else {
+        timers_.Get(tails_[slot])->next = handle;
+    }
+    tails_[slot] = handle;
+}
+
+
+void TimerWheel::Unlink(Timer &timer)
+{
+    if (timer.previous.IsNull()) {
+        heads_[timer.slot] = timer.next;
+    }
+    else {
+        timers_.Get(timer.previous)->next = timer.next;
+    }
+    if (timer.next.IsNull()) {
+        tails_[timer.slot] = timer.previous;
+    }
+    else {
+        timers_.Get(timer.next)->previous = timer.previous;
+    }
+}
+
+
+void TimerWheel::Tick(std::vector<TimerEvent> &expired)
+{
+    now_++;
+
+    // Spread the slots of the levels that wrapped around over the levels
+    // below, top level first so timers can move down more than one level
+    for (int level = num_levels_ - 1; level > 0; level--) {
+        if ((now_ & ((1LL << (slot_bits_ * level)) - 1)) != 0) continue;
+        int slot = level * num_slots_ + (int)((now_ >> (slot_bits_ * level)) & (num_slots_ - 1));
+
+        // Take the whole list out of the slot before putting its timers back
+        Handle handle = heads_[slot];
+        heads_[slot] = Handle();
+        tails_[slot] = Handle();
+        while (!handle.IsNull()) {
+            Timer *timer = timers_.Get(handle);
+            Handle next = timer->next;
+            Insert(handle, *timer);
+            handle = next;
+        }
+    }
+
+    // Expire the timers of this tick
+    int slot = (int)(now_ & (num_slots_ - 1));
+    Handle handle = heads_[slot];
+    heads_[slot] = Handle();
+    tails_[slot] = Handle();
+    while (!handle.IsNull()) {
+        Timer *timer = timers_.Get(handle);
+        Handle next = timer->next;
+        expired.push_back(timer->event);
+        timers_.Remove(handle);
+        handle = next;
+    }
+}
+
+} // namespace game
@@ -0,0 +1,98 @@
+#ifndef TIMER_WHEEL_H_
+#define TIMER_WHEEL_H_
+
+#include <vector>
+
+#include "clock.h"
+#include "slot_map.h"
+
+namespace game {
+
+    // What expired: the object a timer was started for, and the kind of
+    // timer, which the owner of the wheel gives a meaning to
+    struct TimerEvent {
+        Handle object;
+        int kind;
+    };
+
+    // Hierarchical timer wheel, following a clock in ticks of fixed length
+    // Level 0 has a slot for each of the next 64 ticks, and every level
+    // above covers 64 times the span of the one below; when a level wraps
+    // around, the next slot of the level above is spread over it
+    // Starting, cancelling and expiring a timer are O(1), and a running
+    // timer costs nothing until it expires
+    // Each slot is a list linked through the timers themselves, so once the
+    // timers are reserved the wheel never touches the heap
+    class TimerWheel {
+
+        public:
+            TimerWheel(void);
+
+            // Follow a clock, in ticks of tick_length seconds
+            // The wheel starts at the clock's current time
+            void Init(const Clock *clock, double tick_length);
+
+            // Start a timer that expires delay seconds from now, rounded
+            // to whole ticks and at least one tick
+            Handle Start(double delay, const TimerEvent &event);
+
+            // Stop a timer before it expires
+            // Returns false if it already expired or was cancelled
+            bool Cancel(const Handle &timer);
+
+            // Catch up with the clock, adding the events of the timers that
+            // expired to expired, earliest first
+            void Advance(std::vector<TimerEvent> &expired);
+
+            // Stop all timers
+            void Clear(void);
+
+            // Make room for count running timers, so starting up to that
+            // many never allocates
+            void Reserve(int count);
+
+            // Timers running
+            inline int GetNumTimers(void) const { return timers_.Size(); }
+
+        private:
+            static const int slot_bits_ = 6;
+            static const int num_slots_ = 1 << slot_bits_;
+            static const int num_levels_ = 4;
+
+            struct Timer {
+                TimerEvent event;
+                // Tick on which the timer expires
+                long long expiry;
+                // Neighbours in the slot's list, and the slot, as level *
+                // num_slots_ + slot
+                Handle previous;
+                Handle next;
+                int slot;
+            };
+
+            // Put a timer at the end of the slot that comes up next before
+            // its expiry
+            void Insert(const Handle &handle, Timer &timer);
+
+            // Take a timer out of its slot's list
+            void Unlink(Timer &timer);
+
+            // Move to the next tick
+            void Tick(std::vector<TimerEvent> &expired);
+
+            const Clock *clock_;
+            double tick_length_;
+            long long now_;
+
+            SlotMap<Timer> timers_;
+
+            // First and last timer of each slot, in the order they were
+            // put there
+            Handle heads_[num_levels_ * num_slots_];
+            Handle tails_[num_levels_ * num_slots_];
+
+    }; // class TimerWheel
+
+} // namespace game
+
+#endif // TIMER_WHEEL_H_
@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+#include "wave_timeline.h"
+#include "file_utils.h"
+
+namespace game {
+
+// Name of each kind of object in wave files, and its default health and
+// scale
+struct WaveTypeInfo {
+    const char *name;
+    WaveObjectType type;
+    int health;
+    float scale;
+};
+
+const WaveTypeInfo wave_types_g[] = {
+    { "mine", WaveMine, 2, 1.0f },
+    { "sub", WaveSub, 5, 1.0f },
+    { "shark", WaveShark, 7, 1.5f },
+    { "boss", WaveBoss, 20, 8.0f },
+    { "repair", WaveRepairKit, 1, 0.75f },
+    { "upgrade", WaveDamageUpgrade, 1, 1.25f },
+    { "power", WaveInvinciblePower, 1, 1.5f },
+    { "javelin", WaveJavelin, 1, 1.0f },
+    { "trail", WaveTrail, 1, 0.2f }
+};
+const int num_wave_types_g = sizeof(wave_types_g) / sizeof(wave_types_g[0]);
+
+
+// Read a pair of numbers written as x,y
+static bool ParsePair(const std::string &text, glm::vec2 &value)
+{
+    std::istringstream in(text);
+    char comma;
+    return (in >> value.x >> comma >> value.y) && comma == ',' && in.eof();
+}
+
+
+WaveTimeline::WaveTimeline(void)
+{
+    cursor_ = 0;
+}
+
+
+void WaveTimeline::Load(const std::string &filename)
+{
+    Parse(LoadTextFile(filename.c_str()), filename);
+}
+
+
+void WaveTimeline::Parse(const std::string &text, const std::string &name)
+{
+    events_.clear();
+    cursor_ = 0;
+
+    std::istringstream lines(text);
+    std::string line;
+    int line_number = 0;
+    while (std::getline(lines, line)) {
+        line_number++;
+        std::string error_prefix = name + ":" + std::to_string(line_number) + ": ";
+
+        // Drop the comment, skip empty lines
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) line.erase(comment);
+        std::istringstream in(line);
+        WaveEvent event;
+        std::string type_name;
+        if (!(in >> event.time)) {
+            if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+            throw(std::runtime_error(error_prefix + "Expected a time"));
+        }
+        if (!(in >> type_name >> event.offset.x >> event.offset.y)) {
+            throw(std::runtime_error(error_prefix + "Expected a type and an offset"));
+        }
+
+        int type = 0;
+        while (type < num_wave_types_g && type_name != wave_types_g[type].name) type++;
+        if (type == num_wave_types_g) {
+            throw(std::runtime_error(error_prefix + "Unknown object type " + type_name));
+        }
+        event.type = wave_types_g[type].type;
+        event.health = wave_types_g[type].health;
+        event.scale = wave_types_g[type].scale;
+        event.orbit = event.offset;
+
+        // Optional fields
+        int count = 1;
+        glm::vec2 spacing(0.0f, 0.0f);
+        std::string field;
+        while (in >> field) {
+            size_t equals = field.find('=');
+            std::string key = field.substr(0, equals);
+            std::istringstream value(equals == std::string::npos ? std::string() : field.substr(equals + 1));
+            bool ok = false;
+            if (key == "health") ok = (value >> event.health) && value.eof();
+            else if (key == "scale") ok = (value >> event.scale) && value.eof();
+            else if (key == "count") ok = (value >> count) && value.eof() && count > 0;
+            else if (key == "orbit") ok = ParsePair(value.str(), event.orbit);
+            else if (key == "spacing") ok = ParsePair(value.str(), spacing);
+            if (!ok) {
+                throw(std::runtime_error(error_prefix + "Bad field " + field));
+            }
+        }
+
+        for (int i = 0; i < count; i++) {
+            WaveEvent copy = event;
+            copy.offset += (float)i * spacing;
+            copy.orbit += (float)i * spacing;
+            events_.push_back(copy);
+        }
+    }
+
+    // Events at the same time spawn in the order of the file
+    std::stable_sort(events_.begin(), events_.end(), [](const WaveEvent &a, const WaveEvent &b) {
+        return a.time < b.time;
+    });
+}
+
+
+const WaveEvent *WaveTimeline::Next(double time)
+{
+    if (cursor_ >= events_.size() || events_[cursor_].time > time) return nullptr;
+    return &events_[cursor_++];
+}
+
+} // namespace game
@@ -0,0 +1,70 @@
+#ifndef WAVE_TIMELINE_H_
+#define WAVE_TIMELINE_H_
+
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace game {
+
+    // Kinds of object a wave can spawn
+    enum WaveObjectType { WaveMine, WaveSub, WaveShark, WaveBoss, WaveRepairKit, WaveDamageUpgrade, WaveInvinciblePower,
+        WaveJavelin, WaveTrail };
+
+    // One object spawned by a wave
+    struct WaveEvent {
+        // Seconds of game time at which the object spawns
+        double time;
+        WaveObjectType type;
+        // Position relative to the camera when the object spawns
+        glm::vec2 offset;
+        int health;
+        float scale;
+        // Center a mine circles around, relative to the camera
+        glm::vec2 orbit;
+    };
+
+    // The enemy waves of a game, read from a wave file and sorted by time
+    // Events are taken in order with a cursor, so each step only looks at
+    // the events that are due
+    //
+    // Each line of a wave file is one event, or a row of events:
+    //     time type x y [health=N] [scale=S] [orbit=x,y] [count=N] [spacing=dx,dy]
+    // type is mine, sub, shark, boss, repair, upgrade, power, javelin (a
+    // player shot flying up) or trail (a particle trail left in place), and
+    // x y is the offset from the camera; health and scale default to the
+    // type's values, and a mine's orbit to its offset
+    // count repeats the event, moving each copy (and its orbit) by spacing
+    // Everything after a # is a comment
+    class WaveTimeline {
+
+        public:
+            WaveTimeline(void);
+
+            // Read a wave file, replacing the events loaded before
+            // Throws std::runtime_error if the file has an error
+            void Load(const std::string &filename);
+
+            // Read events from the text of a wave file; name is used in
+            // error messages
+            void Parse(const std::string &text, const std::string &name);
+
+            // Get the next event due at or before time and move past it,
+            // nullptr if no event is due
+            const WaveEvent *Next(double time);
+
+            // Start again from the first event
+            inline void Rewind(void) { cursor_ = 0; }
+
+            inline int GetNumEvents(void) const { return (int)events_.size(); }
+            inline int GetNumPending(void) const { return (int)events_.size() - cursor_; }
+
+        private:
+            std::vector<WaveEvent> events_;
+            int cursor_;
+
+    }; // class WaveTimeline
+
+} // namespace game
+
+#endif // WAVE_TIMELINE_H_